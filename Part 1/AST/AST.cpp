@@ -1,4 +1,5 @@
 #include "AST.h"
+#include "../Visitor/Superinstructions.h"
 
 
 /*
@@ -23,9 +24,16 @@ string typeToString(VariableType t) {
 
 ASTProgram::ASTProgram(vector<ASTStatement*> program, int lineNum) {
     this->program = move(program);
+    this->owned = true;
     this->lineNum = lineNum;
 }
 
+ASTProgram::~ASTProgram() {
+    for (ASTStatement* statement : program) {
+        delete statement;
+    }
+}
+
 void ASTProgram::accept(Visitor* v) {
     v->visit(this);
 }
@@ -39,10 +47,16 @@ void ASTProgram::accept(Visitor* v) {
 ASTAssignment::ASTAssignment(ASTIdentifier* identifier, ASTExpression* value, int lineNum) {
     this->identifier = identifier;
     this->value = value;
+    this->fused = UNSELECTED;
     this->lineNum = lineNum;
 }
 
 
+ASTAssignment::~ASTAssignment() {
+    delete identifier;
+    delete value;
+}
+
 void ASTAssignment::accept(Visitor* v) {
     v->visit(this);
 }
@@ -56,9 +70,17 @@ ASTBinOp::ASTBinOp(ASTExpression *lExpression, Operator op, ASTExpression *rExpr
     this->lExpression = lExpression;
     this->op = op;
     this->rExpression = rExpression;
+    this->induction = nullptr;
+    this->fused = UNSELECTED;
     this->lineNum = lineNum;
 }
 
+ASTBinOp::~ASTBinOp() {
+    //The induction is owned by the loop which reduced the multiplication
+    delete lExpression;
+    delete rExpression;
+}
+
 void ASTBinOp::accept(Visitor* v) {
     v->visit(this);
 }
@@ -73,6 +95,12 @@ ASTBlock::ASTBlock(vector<ASTStatement*> block, int lineNum) {
     this->lineNum = lineNum;
 }
 
+ASTBlock::~ASTBlock() {
+    for (ASTStatement* statement : block) {
+        delete statement;
+    }
+}
+
 void ASTBlock::accept(Visitor* v) {
     v->visit(this);
 }
@@ -87,9 +115,25 @@ ASTFor::ASTFor(ASTVariableDecl* declaration, ASTExpression* conditional, ASTAssi
     this->conditional = conditional;
     this->assignment = assignment;
     this->block = block;
+    this->counted = nullptr;
     this->lineNum = lineNum;
 }
 
+ASTFor::~ASTFor() {
+    delete declaration;
+    delete conditional;
+    delete assignment;
+    delete block;
+
+    //The annotation only points into the loop, so only its own structures are freed
+    if (counted != nullptr) {
+        for (DerivedInduction* derived : counted->derived) {
+            delete derived;
+        }
+        delete counted;
+    }
+}
+
 void ASTFor::accept(Visitor* v) {
     v->visit(this);
 }
@@ -105,6 +149,10 @@ ASTFormalParam::ASTFormalParam(ASTIdentifier* identifier, VariableType type, int
     this->lineNum = lineNum;
 }
 
+ASTFormalParam::~ASTFormalParam() {
+    delete identifier;
+}
+
 void ASTFormalParam::accept(Visitor* v) {
     v->visit(this);
 }
@@ -120,6 +168,13 @@ ASTFunctionCall::ASTFunctionCall(ASTIdentifier* identifier, vector<ASTExpression
     this->lineNum = lineNum;
 }
 
+ASTFunctionCall::~ASTFunctionCall() {
+    delete identifier;
+    for (ASTExpression* expression : param) {
+        delete expression;
+    }
+}
+
 void ASTFunctionCall::accept(Visitor* v) {
     v->visit(this);
 }
@@ -137,6 +192,14 @@ ASTFunctionDecl::ASTFunctionDecl(VariableType returnType, ASTIdentifier* identif
     this->lineNum = lineNum;
 }
 
+ASTFunctionDecl::~ASTFunctionDecl() {
+    delete identifier;
+    for (ASTFormalParam* parameter : parameters) {
+        delete parameter;
+    }
+    delete block;
+}
+
 void ASTFunctionDecl::accept(Visitor* v) {
     v->visit(this);
 }
@@ -168,6 +231,12 @@ ASTIf::ASTIf(ASTExpression* conditional, ASTBlock* ifBlock, ASTBlock* elseBlock,
     this->lineNum = lineNum;
 }
 
+ASTIf::~ASTIf() {
+    delete conditional;
+    delete ifBlock;
+    delete elseBlock;
+}
+
 void ASTIf::accept(Visitor* v) {
     v->visit(this);
 }
@@ -231,7 +300,7 @@ VariableType ASTLiteralInt::getType() {
  * ASTLiteralString
  */
 
-ASTLiteralString::ASTLiteralString(string s, int lineNum) {
+ASTLiteralString::ASTLiteralString(TeaString s, int lineNum) {
     this->s = move(s);
     this->lineNum = lineNum;
 }
@@ -254,6 +323,10 @@ ASTPrint::ASTPrint(ASTExpression* expression, int lineNum) {
     this->lineNum = lineNum;
 }
 
+ASTPrint::~ASTPrint() {
+    delete expression;
+}
+
 void ASTPrint::accept(Visitor* v) {
     v->visit(this);
 }
@@ -268,6 +341,10 @@ ASTReturn::ASTReturn(ASTExpression* returnValue, int lineNum) {
     this->lineNum = lineNum;
 }
 
+ASTReturn::~ASTReturn() {
+    delete returnValue;
+}
+
 void ASTReturn::accept(Visitor* v) {
     v->visit(this);
 }
@@ -283,6 +360,10 @@ ASTUnary::ASTUnary(Operator op, ASTExpression* expression, int lineNum) {
     this->lineNum = lineNum;
 }
 
+ASTUnary::~ASTUnary() {
+    delete expression;
+}
+
 void ASTUnary::accept(Visitor* v) {
     v->visit(this);
 }
@@ -299,6 +380,11 @@ ASTVariableDecl::ASTVariableDecl(ASTIdentifier* identifier, VariableType type, A
     this->lineNum = lineNum;
 }
 
+ASTVariableDecl::~ASTVariableDecl() {
+    delete identifier;
+    delete value;
+}
+
 void ASTVariableDecl::accept(Visitor* v) {
     v->visit(this);
 }
@@ -314,6 +400,11 @@ ASTWhile::ASTWhile(ASTExpression* conditional, ASTBlock* block, int lineNum) {
     this->lineNum = lineNum;
 }
 
+ASTWhile::~ASTWhile() {
+    delete conditional;
+    delete block;
+}
+
 void ASTWhile::accept(Visitor* v) {
     v->visit(this);
 }
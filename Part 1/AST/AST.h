@@ -5,6 +5,7 @@
 #include <string>
 
 #include "../Visitor/Visitor.h"
+#include "../Runtime/TeaString.h"
 
 using namespace std;
 
@@ -39,10 +40,21 @@ enum Operator {
 string typeToString(VariableType t);
 
 
+//Optimisation annotations, defined at the end of the file
+struct CountedLoop;
+struct DerivedInduction;
+
+//Defined in Superinstructions.h
+enum Superinstruction : int;
+
+
 //Abstract Classes
+//Each node owns its children, and deleting a node deletes everything below it.
+//Nodes loaded by a BinaryLoader live in its arena instead, and are freed with the loader rather than deleted.
 
 class ASTNode {
 public:
+    virtual ~ASTNode() = default;
     virtual void accept(Visitor* v) = 0;
     int lineNum;    //Used when outputting error messages
 };
@@ -50,6 +62,7 @@ public:
 class ASTStatement : public ASTNode {};
 class ASTExpression : public ASTNode {};
 class ASTLiteral : public ASTExpression {
+public:
     virtual VariableType getType() = 0; //Returns the type of the Literal stored
 };
 
@@ -63,9 +76,11 @@ class ASTLiteral : public ASTExpression {
 class ASTProgram : public ASTNode {
 public:
     ASTProgram(vector<ASTStatement*> program, int lineNum);
+    ~ASTProgram() override;
     void accept(Visitor* v) override;
 
     vector<ASTStatement*> program;
+    bool owned;     //False if the nodes live in a BinaryLoader's arena, so no node may be deleted
 };
 
 
@@ -73,27 +88,35 @@ public:
 class ASTAssignment : public ASTStatement {
 public:
     ASTAssignment(ASTIdentifier* identifier, ASTExpression* value, int lineNum);
+    ~ASTAssignment() override;
     void accept(Visitor* v) override;
 
     ASTIdentifier* identifier;
     ASTExpression* value;
+
+    Superinstruction fused; //Chosen by the interpreter the first time the assignment is run
 };
 
 
 class ASTBinOp : public ASTExpression {
 public:
     ASTBinOp(ASTExpression* lExpression, Operator op, ASTExpression* rExpression, int lineNum);
+    ~ASTBinOp() override;
     void accept(Visitor* v) override;
 
     ASTExpression* lExpression;
     Operator op;
     ASTExpression* rExpression;
+
+    DerivedInduction* induction; //Set by the optimiser if the multiplication was reduced to an addition
+    Superinstruction fused;      //Chosen by the interpreter the first time the operation is run
 };
 
 
 class ASTBlock : public ASTStatement {
 public:
     explicit ASTBlock(vector<ASTStatement*> block, int lineNum);
+    ~ASTBlock() override;
     void accept(Visitor* v) override;
 
     vector<ASTStatement*> block; //Can be empty
@@ -103,18 +126,22 @@ public:
 class ASTFor : public ASTStatement {
 public:
     ASTFor(ASTVariableDecl* declaration, ASTExpression* conditional, ASTAssignment* assignment,  ASTBlock* block, int lineNum);
+    ~ASTFor() override;
     void accept(Visitor* v) override;
 
     ASTVariableDecl* declaration; //Can be null
     ASTExpression* conditional;
     ASTAssignment* assignment; //Can be null
     ASTBlock* block;
+
+    CountedLoop* counted; //Set by the optimiser if this is a counted loop, null otherwise
 };
 
 
 class ASTFormalParam : public ASTNode {
 public:
     ASTFormalParam(ASTIdentifier* identifier, VariableType type, int lineNum);
+    ~ASTFormalParam() override;
     void accept(Visitor* v) override;
 
     ASTIdentifier* identifier;
@@ -125,6 +152,7 @@ public:
 class ASTFunctionCall : public ASTExpression {
 public:
     ASTFunctionCall(ASTIdentifier* identifier, vector<ASTExpression*> param, int lineNum);
+    ~ASTFunctionCall() override;
     void accept(Visitor* v) override;
 
     ASTIdentifier* identifier;
@@ -135,6 +163,7 @@ public:
 class ASTFunctionDecl : public ASTStatement {
 public:
     ASTFunctionDecl(VariableType returnType, ASTIdentifier* identifier, vector<ASTFormalParam*> parameters, ASTBlock* block, int lineNum);
+    ~ASTFunctionDecl() override;
     void accept(Visitor* v) override;
 
     VariableType returnType;
@@ -156,6 +185,7 @@ public:
 class ASTIf : public ASTStatement {
 public:
     ASTIf(ASTExpression* conditional, ASTBlock* ifBlock, ASTBlock* elseBlock, int lineNum);
+    ~ASTIf() override;
     void accept(Visitor* v) override;
 
     ASTExpression* conditional;
@@ -196,17 +226,18 @@ public:
 
 class ASTLiteralString : public ASTLiteral {
 public:
-    ASTLiteralString(string s, int lineNum);
+    ASTLiteralString(TeaString s, int lineNum);
     void accept(Visitor* v) override;
     VariableType getType() override;
 
-    string s;
+    TeaString s;
 };
 
 
 class ASTPrint : public ASTStatement {
 public:
     ASTPrint(ASTExpression* expression, int lineNum);
+    ~ASTPrint() override;
     void accept(Visitor* v) override;
 
     ASTExpression* expression;
@@ -216,6 +247,7 @@ public:
 class ASTReturn : public ASTStatement {
 public:
     ASTReturn(ASTExpression* returnValue, int lineNum);
+    ~ASTReturn() override;
     void accept(Visitor* v) override;
 
     ASTExpression* returnValue;
@@ -225,6 +257,7 @@ public:
 class ASTUnary : public ASTExpression {
 public:
     ASTUnary(Operator op, ASTExpression* expression, int lineNum);
+    ~ASTUnary() override;
     void accept(Visitor* v) override;
 
     Operator op;
@@ -235,6 +268,7 @@ public:
 class ASTVariableDecl : public ASTStatement{
 public:
     ASTVariableDecl(ASTIdentifier* identifier, VariableType type, ASTExpression* value, int lineNum);
+    ~ASTVariableDecl() override;
     void accept(Visitor* v) override;
 
     ASTIdentifier* identifier;
@@ -246,6 +280,7 @@ public:
 class ASTWhile : public ASTStatement {
 public:
     ASTWhile(ASTExpression* conditional, ASTBlock* block, int lineNum);
+    ~ASTWhile() override;
     void accept(Visitor* v) override;
 
     ASTExpression* conditional;
@@ -253,4 +288,43 @@ public:
 };
 
 
+
+//Optimisation Annotations
+//These are filled in by the OptimiserVisitor and used by the InterpreterVisitor.
+
+
+/*
+ * A multiplication of an induction variable by a loop invariant factor, eg. i*3.
+ * Rather than multiplying on every iteration, the product is kept up to date
+ * by adding factor*step to it whenever the induction variable is incremented.
+ */
+struct DerivedInduction {
+    ASTExpression* factor;  //The loop invariant operand of the multiplication
+
+    //Only valid while the loop is running
+    bool active;            //False if the factor did not evaluate to an int
+    int factorValue;        //The value of the factor when the loop was entered
+    int value;              //The current value of the product
+    int step;               //Added to the value after every iteration
+};
+
+
+/*
+ * A for loop of the form: for (let i:int = a; i < n; i = i + c)
+ * The induction variable i is kept as a native int and the bound n
+ * is only evaluated once if it cannot change inside the loop.
+ * If the bound is invariant the loop can also be partially unrolled,
+ * running several iterations each time the condition is checked.
+ */
+struct CountedLoop {
+    Operator op;                        //LESSTHAN or LESSTHANEQUAL
+    ASTExpression* bound;               //The right hand side of the condition
+    bool invariantBound;                //True if the bound cannot change inside the loop
+    int step;                           //The constant added to the induction variable
+    int unroll;                         //Number of iterations run between each check of the condition
+
+    vector<DerivedInduction*> derived;  //Multiplications by i that were reduced to additions
+};
+
+
 #endif //AST_H
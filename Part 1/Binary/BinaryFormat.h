@@ -0,0 +1,99 @@
+#ifndef CPS2000_ASSIGNMENT_BINARYFORMAT_H
+#define CPS2000_ASSIGNMENT_BINARYFORMAT_H
+
+#include <cstdint>
+
+#define BINARY_AST_MAGIC "TEAAST\r\n"   //First bytes of every binary AST file
+#define BINARY_AST_MAGIC_LENGTH 8
+#define BINARY_AST_VERSION 2            //Increased whenever the layout changes
+#define BINARY_AST_NONE 0xFFFFFFFFu     //Index of a missing optional child
+
+
+/*
+ * A binary AST file is laid out as
+ *      BinaryHeader
+ *      BinaryNode[nodeCount]           every node, children always before their parent
+ *      uint32_t[childCount]            the node indices of every list of children
+ *      BinaryString[stringCount]       where each string is in the character data
+ *      char[stringBytes]               the characters of identifiers, string literals and the source, if kept
+ *
+ * All values are in the byte order of the machine which wrote the file.
+ */
+
+
+/*
+ * The class of a node, one for each class of the AST.
+ */
+enum BinaryKind : uint8_t {
+    B_PROGRAM = 0,
+    B_ASSIGNMENT,
+    B_BINOP,
+    B_BLOCK,
+    B_FOR,
+    B_FORMALPARAM,
+    B_FUNCTIONCALL,
+    B_FUNCTIONDECL,
+    B_IDENTIFIER,
+    B_IF,
+    B_LITERALBOOL,
+    B_LITERALFLOAT,
+    B_LITERALINT,
+    B_LITERALSTRING,
+    B_PRINT,
+    B_RETURN,
+    B_UNARY,
+    B_VARIABLEDECL,
+    B_WHILE
+};
+
+
+struct BinaryHeader {
+    char magic[BINARY_AST_MAGIC_LENGTH];
+    uint32_t version;
+    uint32_t root;              //Index of the program node
+    uint32_t nodeCount;
+    uint32_t childCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+    uint32_t source;            //Index of the string holding the source the program was checked from, or none
+};
+
+
+/*
+ * A node of the AST. The meaning of the fields depends on its kind:
+ *      Program, Block          a = first child, b = number of children
+ *      Assignment              a = identifier, b = value
+ *      BinOp                   detail = operator, a = left operand, b = right operand
+ *      For                     a = declaration or none, b = condition, c = assignment or none, d = block
+ *      FormalParam             detail = type, a = identifier
+ *      FunctionCall            a = identifier, b = first argument, c = number of arguments
+ *      FunctionDecl            detail = return type, a = identifier, b = first parameter, c = number of parameters, d = block
+ *      Identifier              a = string
+ *      If                      a = condition, b = if block, c = else block or none
+ *      Literal                 a = the value, or its string, floats are stored as their bits
+ *      Print, Return           a = expression
+ *      Unary                   detail = operator, a = expression
+ *      VariableDecl            detail = type, a = identifier, b = value
+ *      While                   a = condition, b = block
+ * Lists of children are stored in the child array, from the index given by the node.
+ */
+struct BinaryNode {
+    BinaryKind kind;
+    uint8_t detail;
+    uint16_t unused;
+    uint32_t lineNum;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+    uint32_t d;
+};
+
+
+struct BinaryString {
+    uint32_t offset;            //From the start of the character data
+    uint32_t length;
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_BINARYFORMAT_H
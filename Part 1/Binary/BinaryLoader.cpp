@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BinaryLoader.h"
+
+#define ARENA_ALIGNMENT alignof(max_align_t)
+
+
+BinaryLoader::BinaryLoader(const string& fileName) {
+    this->fileName = fileName;
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+    this->header = nullptr;
+    this->nodes = nullptr;
+    this->children = nullptr;
+    this->strings = nullptr;
+    this->characters = nullptr;
+    this->arena = nullptr;
+    this->arenaSize = 0;
+    this->arenaUsed = 0;
+}
+
+BinaryLoader::~BinaryLoader() {
+    //The nodes were constructed in place, so they are destroyed without being deleted.
+    //Each is detached from its children first, as a node's destructor deletes its children
+    for (size_t i = 0; i < built.size(); i++) {
+        detach(built[i], nodes[i].kind);
+        built[i]->~ASTNode();
+    }
+    free(arena);
+
+    if (mapping != nullptr) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+
+/*
+ * Checks if a file starts with the magic bytes of a binary AST, rather than being TeaLang source.
+ */
+bool BinaryLoader::isBinary(const string& fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    char magic[BINARY_AST_MAGIC_LENGTH];
+    bool binary = read(fd, magic, sizeof(magic)) == (ssize_t) sizeof(magic)
+                  && memcmp(magic, BINARY_AST_MAGIC, BINARY_AST_MAGIC_LENGTH) == 0;
+
+    close(fd);
+    return binary;
+}
+
+
+/*
+ * Builds the program stored in the file.
+ */
+ASTProgram* BinaryLoader::load() {
+    if (header == nullptr) {
+        mapFile();
+    }
+
+    //Size the arena for every node, so nodes never move once constructed
+    arenaSize = 0;
+    for (uint32_t i = 0; i < header->nodeCount; i++) {
+        arenaSize += sizeOf(nodes[i].kind);
+    }
+
+    arena = static_cast<char*>(aligned_alloc(ARENA_ALIGNMENT, max(arenaSize, (size_t) ARENA_ALIGNMENT)));
+    if (arena == nullptr) {
+        throw bad_alloc();
+    }
+
+    //Children come before their parents, so each node can be built from nodes already built
+    built.reserve(header->nodeCount);
+    used.assign(header->nodeCount, false);
+
+    for (uint32_t i = 0; i < header->nodeCount; i++) {
+        built.push_back(build(nodes[i], i));
+    }
+
+    //The loader frees the arena, so the nodes must never be deleted
+    auto program = child<ASTProgram>(header->root, header->nodeCount);
+    program->owned = false;
+    return program;
+}
+
+
+/*
+ * Checks if the file was written for the given source.
+ * False if it does not keep its source. Can be called before loading the program, so a mismatch builds no nodes.
+ */
+bool BinaryLoader::isSource(const string& source) {
+    if (header == nullptr) {
+        mapFile();
+    }
+
+    if (header->source == BINARY_AST_NONE) {
+        return false;
+    }
+
+    if (header->source >= header->stringCount
+        || (size_t) strings[header->source].offset + strings[header->source].length > header->stringBytes) {
+        invalid("its source is outside the character data");
+    }
+
+    //Compared in place, as the source may be long
+    const BinaryString& kept = strings[header->source];
+    return kept.length == source.size() && memcmp(characters + kept.offset, source.data(), source.size()) == 0;
+}
+
+
+/*
+ * Maps the file into memory and finds each of its sections, checking they fit in the file.
+ */
+void BinaryLoader::mapFile() {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("File " + fileName + " could not be opened.");
+    }
+
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(BinaryHeader)) {
+        close(fd);
+        invalid("it is too short");
+    }
+
+    mappingSize = (size_t) info.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw runtime_error("File " + fileName + " could not be mapped.");
+    }
+
+
+    auto start = static_cast<const char*>(mapping);
+    header = reinterpret_cast<const BinaryHeader*>(start);
+
+    if (memcmp(header->magic, BINARY_AST_MAGIC, BINARY_AST_MAGIC_LENGTH) != 0) {
+        invalid("it is not a binary AST");
+    }
+    if (header->version != BINARY_AST_VERSION) {
+        invalid("it was written by a different version, " + to_string(header->version));
+    }
+
+    size_t expected = sizeof(BinaryHeader)
+                      + (size_t) header->nodeCount * sizeof(BinaryNode)
+                      + (size_t) header->childCount * sizeof(uint32_t)
+                      + (size_t) header->stringCount * sizeof(BinaryString)
+                      + (size_t) header->stringBytes;
+
+    if (expected != mappingSize) {
+        invalid("its size does not match its header");
+    }
+
+    nodes = reinterpret_cast<const BinaryNode*>(start + sizeof(BinaryHeader));
+    children = reinterpret_cast<const uint32_t*>(nodes + header->nodeCount);
+    strings = reinterpret_cast<const BinaryString*>(children + header->childCount);
+    characters = reinterpret_cast<const char*>(strings + header->stringCount);
+}
+
+
+/*
+ * Clears a node's pointers to its children, so destroying it leaves them alone.
+ */
+void BinaryLoader::detach(ASTNode* node, BinaryKind kind) {
+    switch (kind) {
+        case B_PROGRAM:         static_cast<ASTProgram*>(node)->program.clear(); break;
+        case B_BLOCK:           static_cast<ASTBlock*>(node)->block.clear(); break;
+        case B_FORMALPARAM:     static_cast<ASTFormalParam*>(node)->identifier = nullptr; break;
+        case B_PRINT:           static_cast<ASTPrint*>(node)->expression = nullptr; break;
+        case B_RETURN:          static_cast<ASTReturn*>(node)->returnValue = nullptr; break;
+        case B_UNARY:           static_cast<ASTUnary*>(node)->expression = nullptr; break;
+
+        case B_ASSIGNMENT: {
+            auto assignment = static_cast<ASTAssignment*>(node);
+            assignment->identifier = nullptr;
+            assignment->value = nullptr;
+            break;
+        }
+
+        case B_BINOP: {
+            auto binOp = static_cast<ASTBinOp*>(node);
+            binOp->lExpression = nullptr;
+            binOp->rExpression = nullptr;
+            break;
+        }
+
+        case B_FOR: {
+            auto forNode = static_cast<ASTFor*>(node);
+            forNode->declaration = nullptr;
+            forNode->conditional = nullptr;
+            forNode->assignment = nullptr;
+            forNode->block = nullptr;
+            break;
+        }
+
+        case B_FUNCTIONCALL: {
+            auto call = static_cast<ASTFunctionCall*>(node);
+            call->identifier = nullptr;
+            call->param.clear();
+            break;
+        }
+
+        case B_FUNCTIONDECL: {
+            auto func = static_cast<ASTFunctionDecl*>(node);
+            func->identifier = nullptr;
+            func->parameters.clear();
+            func->block = nullptr;
+            break;
+        }
+
+        case B_IF: {
+            auto ifNode = static_cast<ASTIf*>(node);
+            ifNode->conditional = nullptr;
+            ifNode->ifBlock = nullptr;
+            ifNode->elseBlock = nullptr;
+            break;
+        }
+
+        case B_VARIABLEDECL: {
+            auto declaration = static_cast<ASTVariableDecl*>(node);
+            declaration->identifier = nullptr;
+            declaration->value = nullptr;
+            break;
+        }
+
+        case B_WHILE: {
+            auto whileNode = static_cast<ASTWhile*>(node);
+            whileNode->conditional = nullptr;
+            whileNode->block = nullptr;
+            break;
+        }
+
+        default:
+            //Identifiers and literals have no children
+            break;
+    }
+}
+
+
+/*
+ * The space taken in the arena by a node of the given kind.
+ */
+size_t BinaryLoader::sizeOf(BinaryKind kind) {
+    size_t size;
+
+    switch (kind) {
+        case B_PROGRAM:         size = sizeof(ASTProgram); break;
+        case B_ASSIGNMENT:      size = sizeof(ASTAssignment); break;
+        case B_BINOP:           size = sizeof(ASTBinOp); break;
+        case B_BLOCK:           size = sizeof(ASTBlock); break;
+        case B_FOR:             size = sizeof(ASTFor); break;
+        case B_FORMALPARAM:     size = sizeof(ASTFormalParam); break;
+        case B_FUNCTIONCALL:    size = sizeof(ASTFunctionCall); break;
+        case B_FUNCTIONDECL:    size = sizeof(ASTFunctionDecl); break;
+        case B_IDENTIFIER:      size = sizeof(ASTIdentifier); break;
+        case B_IF:              size = sizeof(ASTIf); break;
+        case B_LITERALBOOL:     size = sizeof(ASTLiteralBool); break;
+        case B_LITERALFLOAT:    size = sizeof(ASTLiteralFloat); break;
+        case B_LITERALINT:      size = sizeof(ASTLiteralInt); break;
+        case B_LITERALSTRING:   size = sizeof(ASTLiteralString); break;
+        case B_PRINT:           size = sizeof(ASTPrint); break;
+        case B_RETURN:          size = sizeof(ASTReturn); break;
+        case B_UNARY:           size = sizeof(ASTUnary); break;
+        case B_VARIABLEDECL:    size = sizeof(ASTVariableDecl); break;
+        case B_WHILE:           size = sizeof(ASTWhile); break;
+        default:                size = 0; break;
+    }
+
+    //Keep every node aligned
+    return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+
+/*
+ * Constructs the AST node stored at the given index.
+ */
+ASTNode* BinaryLoader::build(const BinaryNode& node, uint32_t index) {
+    int lineNum = (int) node.lineNum;
+    float f;
+
+    switch (node.kind) {
+        case B_PROGRAM:
+            return make<ASTProgram>(list<ASTStatement>(node.a, node.b, index), lineNum);
+
+        case B_ASSIGNMENT:
+            return make<ASTAssignment>(child<ASTIdentifier>(node.a, index), child<ASTExpression>(node.b, index), lineNum);
+
+        case B_BINOP:
+            return make<ASTBinOp>(child<ASTExpression>(node.a, index), op(node.detail),
+                                  child<ASTExpression>(node.b, index), lineNum);
+
+        case B_BLOCK:
+            return make<ASTBlock>(list<ASTStatement>(node.a, node.b, index), lineNum);
+
+        case B_FOR:
+            return make<ASTFor>(optional<ASTVariableDecl>(node.a, index), child<ASTExpression>(node.b, index),
+                                optional<ASTAssignment>(node.c, index), child<ASTBlock>(node.d, index), lineNum);
+
+        case B_FORMALPARAM:
+            return make<ASTFormalParam>(child<ASTIdentifier>(node.a, index), type(node.detail), lineNum);
+
+        case B_FUNCTIONCALL:
+            return make<ASTFunctionCall>(child<ASTIdentifier>(node.a, index),
+                                         list<ASTExpression>(node.b, node.c, index), lineNum);
+
+        case B_FUNCTIONDECL:
+            return make<ASTFunctionDecl>(type(node.detail), child<ASTIdentifier>(node.a, index),
+                                         list<ASTFormalParam>(node.b, node.c, index),
+                                         child<ASTBlock>(node.d, index), lineNum);
+
+        case B_IDENTIFIER:
+            return make<ASTIdentifier>(text(node.a), lineNum);
+
+        case B_IF:
+            return make<ASTIf>(child<ASTExpression>(node.a, index), child<ASTBlock>(node.b, index),
+                               optional<ASTBlock>(node.c, index), lineNum);
+
+        case B_LITERALBOOL:
+            return make<ASTLiteralBool>(node.a != 0, lineNum);
+
+        case B_LITERALFLOAT:
+            memcpy(&f, &node.a, sizeof(f));
+            return make<ASTLiteralFloat>(f, lineNum);
+
+        case B_LITERALINT:
+            return make<ASTLiteralInt>((int) node.a, lineNum);
+
+        case B_LITERALSTRING:
+            return make<ASTLiteralString>(TeaString::intern(text(node.a)), lineNum);
+
+        case B_PRINT:
+            return make<ASTPrint>(child<ASTExpression>(node.a, index), lineNum);
+
+        case B_RETURN:
+            return make<ASTReturn>(child<ASTExpression>(node.a, index), lineNum);
+
+        case B_UNARY:
+            return make<ASTUnary>(op(node.detail), child<ASTExpression>(node.a, index), lineNum);
+
+        case B_VARIABLEDECL:
+            return make<ASTVariableDecl>(child<ASTIdentifier>(node.a, index), type(node.detail),
+                                         child<ASTExpression>(node.b, index), lineNum);
+
+        case B_WHILE:
+            return make<ASTWhile>(child<ASTExpression>(node.a, index), child<ASTBlock>(node.b, index), lineNum);
+
+        default:
+            invalid("node " + to_string(index) + " has an unknown kind");
+    }
+}
+
+
+/*
+ * Constructs a node in the next free space of the arena.
+ */
+template <class T, class... Args>
+T* BinaryLoader::make(Args&&... args) {
+    void* space = arena + arenaUsed;
+    arenaUsed += sizeOf(nodes[built.size()].kind);
+
+    return new (space) T(forward<Args>(args)...);
+}
+
+
+/*
+ * Returns a node already built, which must be of the given class and not already have a parent.
+ */
+template <class T>
+T* BinaryLoader::child(uint32_t index, uint32_t parent) {
+    if (index >= parent) {
+        invalid("node " + to_string(parent) + " has a child which is not before it");
+    }
+    if (used[index]) {
+        invalid("node " + to_string(index) + " has more than one parent");
+    }
+
+    auto node = dynamic_cast<T*>(built[index]);
+    if (node == nullptr) {
+        invalid("node " + to_string(parent) + " has a child of the wrong class");
+    }
+
+    used[index] = true;
+    return node;
+}
+
+template <class T>
+T* BinaryLoader::optional(uint32_t index, uint32_t parent) {
+    return (index == BINARY_AST_NONE) ? nullptr : child<T>(index, parent);
+}
+
+template <class T>
+vector<T*> BinaryLoader::list(uint32_t start, uint32_t count, uint32_t parent) {
+    if ((size_t) start + count > header->childCount) {
+        invalid("node " + to_string(parent) + " has children outside the child array");
+    }
+
+    vector<T*> elements;
+    elements.reserve(count);
+    for (uint32_t i = start; i < start + count; i++) {
+        elements.push_back(child<T>(children[i], parent));
+    }
+    return elements;
+}
+
+
+string BinaryLoader::text(uint32_t index) {
+    if (index >= header->stringCount
+        || (size_t) strings[index].offset + strings[index].length > header->stringBytes) {
+        invalid("string " + to_string(index) + " is outside the character data");
+    }
+
+    return string(characters + strings[index].offset, strings[index].length);
+}
+
+
+VariableType BinaryLoader::type(uint8_t detail) {
+    if (detail > STRING) {
+        invalid("unknown type " + to_string(detail));
+    }
+    return (VariableType) detail;
+}
+
+
+Operator BinaryLoader::op(uint8_t detail) {
+    if (detail > NOT) {
+        invalid("unknown operator " + to_string(detail));
+    }
+    return (Operator) detail;
+}
+
+
+void BinaryLoader::invalid(const string& reason) {
+    throw runtime_error("Binary AST " + fileName + " is not valid, " + reason + ".");
+}
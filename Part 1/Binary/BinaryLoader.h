@@ -0,0 +1,74 @@
+#ifndef CPS2000_ASSIGNMENT_BINARYLOADER_H
+#define CPS2000_ASSIGNMENT_BINARYLOADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "BinaryFormat.h"
+#include "../AST/AST.h"
+
+using namespace std;
+
+
+/*
+ * Loads a program from a binary AST file written by the BinaryVisitor, instead of lexing and parsing its source.
+ *
+ * The file is mapped into memory and read in place. Every node is constructed in a single arena sized from
+ * the file, rather than allocated separately, and is checked to be of the class its parent expects.
+ * The nodes belong to the loader, so it must not be destroyed while the program is still in use.
+ */
+class BinaryLoader {
+public:
+    explicit BinaryLoader(const string& fileName);
+    ~BinaryLoader();
+
+    static bool isBinary(const string& fileName);
+
+    ASTProgram* load();
+    bool isSource(const string& source);
+
+
+private:
+    string fileName;
+
+    //The mapped file
+    void* mapping;
+    size_t mappingSize;
+
+    //The sections of the file
+    const BinaryHeader* header;
+    const BinaryNode* nodes;
+    const uint32_t* children;
+    const BinaryString* strings;
+    const char* characters;
+
+    //The nodes constructed so far, in the same order as the file
+    vector<ASTNode*> built;
+    vector<bool> used;
+    char* arena;
+    size_t arenaSize;
+    size_t arenaUsed;
+
+    void mapFile();
+    static size_t sizeOf(BinaryKind kind);
+    static void detach(ASTNode* node, BinaryKind kind);
+    ASTNode* build(const BinaryNode& node, uint32_t index);
+
+    template <class T, class... Args>
+    T* make(Args&&... args);
+    template <class T>
+    T* child(uint32_t index, uint32_t parent);
+    template <class T>
+    T* optional(uint32_t index, uint32_t parent);
+    template <class T>
+    vector<T*> list(uint32_t start, uint32_t count, uint32_t parent);
+
+    string text(uint32_t index);
+    VariableType type(uint8_t detail);
+    Operator op(uint8_t detail);
+    [[noreturn]] void invalid(const string& reason);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_BINARYLOADER_H
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include "CompileCache.h"
+#include "../Visitor/BinaryVisitor.h"
+
+#define FNV_OFFSET_BASIS 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+namespace fs = std::filesystem;
+
+
+CompileCache::CompileCache(const string& directory, uintmax_t maxSize) {
+    this->directory = directory;
+    this->maxSize = maxSize;
+}
+
+CompileCache::~CompileCache() {
+    for (BinaryLoader* loader : loaders) {
+        delete loader;
+    }
+}
+
+
+/*
+ * The 64 bit FNV-1a hash of the compiler version and a program's source.
+ */
+uint64_t CompileCache::hash(const string& source) {
+    uint64_t h = FNV_OFFSET_BASIS;
+
+    string version = string(COMPILER_VERSION) + "/" + to_string(BINARY_AST_VERSION) + '\0';
+    for (unsigned char c : version) {
+        h = (h ^ c) * FNV_PRIME;
+    }
+    for (unsigned char c : source) {
+        h = (h ^ c) * FNV_PRIME;
+    }
+
+    return h;
+}
+
+
+/*
+ * The file which holds the checked program for a source.
+ */
+string CompileCache::entry(const string& source) {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long) hash(source));
+    return directory + "/" + name + CACHE_EXTENSION;
+}
+
+
+/*
+ * Returns the checked program for a source, or null if it is not in the cache.
+ * The program is valid until the cache is destroyed.
+ */
+ASTProgram* CompileCache::load(const string& source) {
+    string path = entry(source);
+
+    error_code error;
+    if (!fs::exists(path, error)) {
+        return nullptr;
+    }
+
+    //The entry may be removed by another process at any point, which is treated as a miss
+    auto loader = new BinaryLoader(path);
+    try {
+        //Two sources may share a hash, so an entry written for a different source is a miss
+        if (!loader->isSource(source)) {
+            delete loader;
+            return nullptr;
+        }
+
+        ASTProgram* program = loader->load();
+
+        //Mark the entry as recently used
+        fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+
+        loaders.push_back(loader);
+        return program;
+    }
+    catch (runtime_error&) {
+        delete loader;
+        return nullptr;
+    }
+}
+
+
+/*
+ * Adds a checked program to the cache, then removes old entries if it has grown too large.
+ * The cache is only an optimisation, so failing to write to it is ignored.
+ */
+void CompileCache::store(const string& source, ASTProgram* program) {
+    try {
+        fs::create_directories(directory);
+
+        BinaryVisitor writer;
+        program->accept(&writer);
+        writer.setSource(source);
+        writer.write(entry(source));
+
+        evict();
+    }
+    catch (exception&) {
+        //Run the program without caching it
+    }
+}
+
+
+/*
+ * Removes the least recently used entries until the cache fits in its size limit.
+ */
+void CompileCache::evict() {
+
+    struct Entry {
+        fs::path path;
+        fs::file_time_type used;
+        uintmax_t size;
+    };
+
+    vector<Entry> entries;
+    uintmax_t total = 0;
+
+    for (const fs::directory_entry& file : fs::directory_iterator(directory)) {
+        error_code error;
+        if (file.path().extension() != CACHE_EXTENSION || !file.is_regular_file(error)) {
+            continue;
+        }
+
+        uintmax_t size = file.file_size(error);
+        fs::file_time_type used = file.last_write_time(error);
+        if (!error) {
+            entries.push_back(Entry{file.path(), used, size});
+            total += size;
+        }
+    }
+
+    if (total <= maxSize) {
+        return;
+    }
+
+    sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+
+    for (const Entry& old : entries) {
+        if (total <= maxSize) {
+            break;
+        }
+
+        error_code error;
+        fs::remove(old.path, error);
+        total -= old.size;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef CPS2000_ASSIGNMENT_COMPILECACHE_H
+#define CPS2000_ASSIGNMENT_COMPILECACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BinaryLoader.h"
+#include "../AST/AST.h"
+
+#define COMPILER_VERSION "1"                //Increase whenever a change to the compiler could change a checked program
+#define DEFAULT_CACHE_SIZE (64 << 20)       //Bytes of cached programs kept before the least recently used are removed
+#define CACHE_EXTENSION ".ast"
+
+using namespace std;
+
+
+/*
+ * An on-disk cache of checked programs, so running the same source again skips lexing, parsing and
+ * semantic analysis. Each program is stored as a binary AST named by a hash of the compiler version and
+ * the source text, so changing either gives a different entry. The source is kept in the entry too, and a
+ * program is only used if it matches, so two sources with the same hash can never run each other's program.
+ *
+ * Several processes can share a directory: entries are written under a temporary name and renamed into
+ * place, so they are never seen half written. Entries are touched when they are used, and the least
+ * recently used are removed once the directory grows beyond its size limit.
+ */
+class CompileCache {
+public:
+    CompileCache(const string& directory, uintmax_t maxSize);
+    ~CompileCache();
+
+    static uint64_t hash(const string& source);
+
+    ASTProgram* load(const string& source);
+    void store(const string& source, ASTProgram* program);
+
+
+private:
+    string directory;
+    uintmax_t maxSize;
+    vector<BinaryLoader*> loaders;  //Own the programs loaded from the cache
+
+    string entry(const string& source);
+    void evict();
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_COMPILECACHE_H
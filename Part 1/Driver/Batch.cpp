@@ -0,0 +1,220 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <unistd.h>
+#include "Batch.h"
+#include "../Runtime/WorkStealingPool.h"
+
+#define COPY_BUFFER_SIZE (1 << 16)
+
+
+Batch::Batch(const vector<string>& fileNames, const BatchOptions& options) {
+    this->fileNames = fileNames;
+    this->options = options;
+    this->milliseconds = 0;
+}
+
+
+/*
+ * Reads the scripts listed in a file, one per line.
+ * Blank lines and lines starting with # are skipped.
+ */
+vector<string> Batch::readList(const string& fileName) {
+    ifstream f(fileName);
+
+    if (!f.is_open()) {
+        throw runtime_error("File " + fileName + " could not be opened.");
+    }
+
+    vector<string> scripts;
+    string line;
+
+    while (getline(f, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#') {
+            continue;
+        }
+
+        size_t end = line.find_last_not_of(" \t\r");
+        scripts.push_back(line.substr(start, end - start + 1));
+    }
+
+    return scripts;
+}
+
+
+/*
+ * Runs every script, returning 0 if they all succeeded and 1 otherwise.
+ */
+int Batch::run() {
+    auto start = chrono::steady_clock::now();
+
+    if (!options.outputDirectory.empty()) {
+        filesystem::create_directories(options.outputDirectory);
+        nameOutputFiles();
+    }
+
+    results.assign(fileNames.size(), BatchResult());
+
+    WorkStealingPool pool(options.threads);
+    pool.run(fileNames.size(), [this](size_t index) { runTask(index); });
+
+    milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    for (const BatchResult& result : results) {
+        if (result.status != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Checks and runs one script, recording how it went.
+ */
+void Batch::runTask(size_t index) {
+    auto start = chrono::steady_clock::now();
+
+    BatchResult& result = results[index];
+    result.fileName = fileNames[index];
+    result.status = 0;
+
+    FILE* file = nullptr;
+
+    try {
+        string source = readScript(result.fileName);
+
+        //The output is collected in the script's own file, or a temporary file until the script is done
+        file = options.outputDirectory.empty() ? tmpfile() : fopen(outputFiles[index].c_str(), "w+");
+        if (file == nullptr) {
+            throw runtime_error("Output of " + result.fileName + " could not be opened.");
+        }
+
+        //Freed once the script has run or stopped with an error, with its literals, which are not interned
+        unique_ptr<ASTProgram> program(compileScript(source, options.run, false));
+
+        //The output is finished when the sink is destroyed, including when the program stops with an error
+        OutputSink output(fileno(file), FLUSH_FULL);
+        runScript(program.get(), &output, options.run);
+    }
+    catch (exception& e) {
+        result.status = 1;
+        result.error = e.what();
+    }
+
+    if (file != nullptr) {
+        if (options.outputDirectory.empty()) {
+            copyOutput(fileno(file), result.fileName);
+        }
+        fclose(file);
+    }
+
+    result.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+
+/*
+ * Chooses the file each script's output is written to, named after its path so scripts in different
+ * directories with the same name are kept apart. A script listed more than once is also numbered by its
+ * position in the list, so each run has its own file.
+ */
+void Batch::nameOutputFiles() {
+    set<string> used;
+    outputFiles.clear();
+
+    for (size_t i = 0; i < fileNames.size(); i++) {
+        string name = fileNames[i];
+
+        if (name.compare(0, 2, "./") == 0) {
+            name = name.substr(2);
+        }
+        for (char& c : name) {
+            if (c == '/') {
+                c = '_';
+            }
+        }
+
+        if (!used.insert(name).second) {
+            name += "." + to_string(i);
+        }
+
+        outputFiles.push_back(options.outputDirectory + "/" + name + ".out");
+    }
+}
+
+
+/*
+ * Writes the output collected from a script to stdout, with each line prefixed by the script's name.
+ */
+void Batch::copyOutput(int fd, const string& fileName) {
+    OutputSink& out = OutputSink::standardOutput();
+    string prefix = fileName + ": ";
+
+    lock_guard<mutex> guard(outputLock);
+    lseek(fd, 0, SEEK_SET);
+
+    char buffer[COPY_BUFFER_SIZE];
+    bool lineStart = true;
+    ssize_t length;
+
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+        const char* next = buffer;
+        const char* end = buffer + length;
+
+        while (next < end) {
+            if (lineStart) {
+                out.write(prefix.data(), prefix.size());
+                lineStart = false;
+            }
+
+            //Copy up to the end of the line, or the end of what has been read
+            auto newline = static_cast<const char*>(memchr(next, '\n', end - next));
+            const char* stop = (newline != nullptr) ? newline : end;
+            out.write(next, stop - next);
+            next = stop;
+
+            if (newline != nullptr) {
+                out.endLine();
+                lineStart = true;
+                next++;
+            }
+        }
+    }
+
+    //Keep the output of different scripts on separate lines
+    if (!lineStart) {
+        out.endLine();
+    }
+}
+
+
+/*
+ * Prints the status and time taken by each script, in the order they were listed.
+ */
+void Batch::printSummary(ostream& out) {
+    size_t failed = 0;
+
+    out << "Status   Time ms  Script" << endl;
+    out << fixed << setprecision(3);
+
+    for (const BatchResult& result : results) {
+        out << left << setw(6) << (result.status == 0 ? "ok" : "error") << right << setw(10) << result.milliseconds
+            << "  " << result.fileName;
+
+        if (result.status != 0) {
+            out << "  " << result.error;
+            failed++;
+        }
+        out << endl;
+    }
+
+    out << results.size() << " scripts, " << results.size() - failed << " succeeded, " << failed << " failed in "
+        << milliseconds << " ms on " << options.threads << (options.threads == 1 ? " thread" : " threads") << endl;
+}
@@ -0,0 +1,68 @@
+#ifndef CPS2000_ASSIGNMENT_BATCH_H
+#define CPS2000_ASSIGNMENT_BATCH_H
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Script.h"
+
+using namespace std;
+
+
+/*
+ * How each script in a batch is run.
+ */
+struct BatchOptions {
+    RunOptions run;
+    int threads;                //Scripts run at the same time
+    string outputDirectory;     //Each script's output is written to its own file here, empty to prefix it on stdout
+};
+
+
+/*
+ * What happened when a script was run.
+ */
+struct BatchResult {
+    string fileName;
+    int status;                 //0 if the script ran to completion, 1 if it stopped with an error
+    string error;
+    double milliseconds;
+};
+
+
+/*
+ * Checks and runs many scripts in one process, on a work stealing pool of threads.
+ *
+ * Each script has its own lexer, parser, visitors, symbol tables, output and string literals, which are not
+ * interned, so a script's tree and literals are all freed once it has run. A script's output is collected while it runs and then either
+ * written to its own file, or written to stdout with each line prefixed by the script's name, with the whole
+ * of one script's output written at once so it is never interleaved with another's.
+ */
+class Batch {
+public:
+    Batch(const vector<string>& fileNames, const BatchOptions& options);
+
+    static vector<string> readList(const string& fileName);
+
+    int run();
+    void printSummary(ostream& out);
+
+
+private:
+    vector<string> fileNames;
+    BatchOptions options;
+    vector<BatchResult> results;    //In the same order as the scripts
+    vector<string> outputFiles;     //Where the output of each script is written, if not to stdout
+    double milliseconds;            //Time taken to run the whole batch
+
+    mutex outputLock;               //Held while a script's output is copied to stdout or stderr
+
+    void runTask(size_t index);
+    void nameOutputFiles();
+    void copyOutput(int fd, const string& fileName);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_BATCH_H
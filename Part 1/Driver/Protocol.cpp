@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Protocol.h"
+
+
+/*
+ * Writes a frame, returning false if the other side has gone away.
+ * A payload longer than MAX_FRAME_LENGTH is split over several frames of the same type.
+ */
+bool writeFrame(int fd, char type, const char* data, size_t length) {
+    do {
+        size_t part = min(length, (size_t) MAX_FRAME_LENGTH);
+
+        char header[FRAME_HEADER_SIZE];
+        header[0] = type;
+        for (int i = 0; i < 4; i++) {
+            header[i + 1] = (char) ((part >> (8 * i)) & 0xFF);
+        }
+
+        if (!sendAll(fd, header, sizeof(header)) || !sendAll(fd, data, part)) {
+            return false;
+        }
+
+        data += part;
+        length -= part;
+    } while (length > 0);
+
+    return true;
+}
+
+
+/*
+ * Reads the next frame, returning false at the end of the connection or if the frame is not valid.
+ */
+bool readFrame(int fd, char* type, string* payload) {
+    char header[FRAME_HEADER_SIZE];
+    size_t received = 0;
+
+    while (received < sizeof(header)) {
+        ssize_t count = read(fd, header + received, sizeof(header) - received);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        received += (size_t) count;
+    }
+
+    size_t length = 0;
+    for (int i = 0; i < 4; i++) {
+        length |= (size_t) (unsigned char) header[i + 1] << (8 * i);
+    }
+    if (length > MAX_FRAME_LENGTH) {
+        return false;
+    }
+
+    *type = header[0];
+    payload->resize(length);
+    received = 0;
+
+    while (received < length) {
+        ssize_t count = read(fd, &(*payload)[received], length - received);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        received += (size_t) count;
+    }
+
+    return true;
+}
+
+
+/*
+ * Writes every byte, retrying after interrupted and partial writes.
+ */
+bool sendAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t count = write(fd, data, length);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            return false;
+        }
+
+        data += count;
+        length -= (size_t) count;
+    }
+
+    return true;
+}
+
+
+/*
+ * Reads until the other side shuts down the connection for writing.
+ * Fails once more than maxLength bytes are read, leaving them in data, or with errno set to EAGAIN if the
+ * connection is not shut down within the given number of seconds of starting.
+ */
+bool receiveAll(int fd, string* data, size_t maxLength, int seconds) {
+    char buffer[1 << 16];
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(seconds);
+
+    while (data->size() <= maxLength) {
+        //Each read may only wait until the deadline, so a client sending a byte at a time cannot keep it waiting
+        auto remaining = chrono::duration_cast<chrono::microseconds>(deadline - chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            errno = EAGAIN;
+            return false;
+        }
+
+        timeval timeout = {(time_t) (remaining.count() / 1000000), (suseconds_t) (remaining.count() % 1000000)};
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+            return false;
+        }
+
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            return false;
+        }
+        if (count == 0) {
+            return true;
+        }
+
+        data->append(buffer, (size_t) count);
+    }
+
+    return false;
+}
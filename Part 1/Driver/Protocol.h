@@ -0,0 +1,34 @@
+#ifndef CPS2000_ASSIGNMENT_PROTOCOL_H
+#define CPS2000_ASSIGNMENT_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define FRAME_OUTPUT 'o'        //Part of the script's printed output
+#define FRAME_ERROR 'e'         //The error which stopped the script
+#define FRAME_STATUS 's'        //The script's exit status, always the last frame
+#define FRAME_HEADER_SIZE 5     //The frame type, then the length of its payload as 4 bytes, least significant first
+#define MAX_FRAME_LENGTH (1 << 24)
+
+using namespace std;
+
+
+/*
+ * The protocol spoken over the socket of a TeaLang server.
+ *
+ * A client connects, writes the source of one script, then shuts down its side of the connection for writing.
+ * The server replies with a sequence of frames, each a header followed by its payload: output frames as the
+ * script prints, an error frame if it stops with an error, and finally a status frame holding the exit status
+ * as text. The server then closes the connection.
+ *
+ * A script which is too long, or is not finished in time, is answered with an error frame instead of being run.
+ */
+bool writeFrame(int fd, char type, const char* data, size_t length);
+bool readFrame(int fd, char* type, string* payload);
+bool sendAll(int fd, const char* data, size_t length);
+bool receiveAll(int fd, string* data, size_t maxLength, int seconds);
+
+
+
+#endif //CPS2000_ASSIGNMENT_PROTOCOL_H
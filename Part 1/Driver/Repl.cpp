@@ -0,0 +1,171 @@
+#include <cctype>
+#include <iostream>
+#include <unistd.h>
+#include "Repl.h"
+#include "Statements.h"
+
+
+Repl::Repl(const RunOptions& options) {
+    EngineOptions engineOptions;
+    engineOptions.optimise = options.optimise;
+    engineOptions.unrollFactor = options.unrollFactor;
+    engineOptions.superinstructions = options.superinstructions;
+    engineOptions.useJIT = options.useJIT;
+    engineOptions.jitThreshold = options.jitThreshold;
+    engineOptions.osrThreshold = options.osrThreshold;
+    engineOptions.maxOperations = options.limits.operations;
+    engineOptions.maxMilliseconds = options.limits.milliseconds;
+    engineOptions.maxDepth = options.limits.depth;
+    engineOptions.maxBytes = options.limits.bytes;
+
+    this->engine = Engine(engineOptions);
+    this->session = engine.createSession();
+    this->interactive = isatty(STDIN_FILENO);
+}
+
+
+/*
+ * Runs statements until the end of the input.
+ * Returns 1 if any statement had an error, like a script which stopped with one, or 0 otherwise.
+ */
+int Repl::run(istream& in) {
+    OutputSink& output = OutputSink::standardOutput();
+    int status = 0;
+
+    string source;      //The lines of the statement being entered
+    int start = 1;      //The line the statement started on
+    int lineNum = 0;
+    string line;
+
+    string held;        //A complete statement ending with }, which an else on a later line would continue
+    int heldStart = 1;
+
+    if (interactive) {
+        cout << REPL_PROMPT << flush;
+    }
+
+    while (getline(in, line)) {
+        lineNum++;
+
+        //The first token after a held statement decides whether it is run, or continued by an else
+        if (!held.empty()) {
+            bool blank;
+            if (startsWithElse(line, &blank)) {
+                source = held;
+                start = heldStart;
+                held.clear();
+            }
+            else if (blank) {
+                held.append(line);
+                held.append("\n");
+                start = lineNum + 1;
+                continue;
+            }
+            else {
+                if (!runStatement(held, heldStart)) {
+                    status = 1;
+                }
+                held.clear();
+            }
+        }
+
+        source.append(line);
+        source.append("\n");
+
+        bool empty;
+        bool endsWithBlock;
+        if (isComplete(source, &empty, &endsWithBlock)) {
+            if (!interactive && endsWithBlock) {
+                held = source;
+                heldStart = start;
+            }
+            else if (!empty && !runStatement(source, start)) {
+                status = 1;
+            }
+
+            source.clear();
+            start = lineNum + 1;
+        }
+
+        if (interactive) {
+            output.flush();
+            cout << (source.empty() ? REPL_PROMPT : REPL_CONTINUATION) << flush;
+        }
+    }
+
+    //No else can follow a statement held at the end of the input
+    if (!held.empty() && !runStatement(held, heldStart)) {
+        status = 1;
+    }
+
+    //A statement left open at the end of the input is still compiled, so its error is reported
+    bool empty;
+    bool endsWithBlock;
+    isComplete(source, &empty, &endsWithBlock);
+    if (!empty && !runStatement(source, start)) {
+        status = 1;
+    }
+
+    if (interactive) {
+        cout << endl;
+    }
+
+    output.finish();
+    return status;
+}
+
+
+/*
+ * Compiles and runs one statement in the session, printing its error if it has one.
+ * Returns true if it ran without an error.
+ */
+bool Repl::runStatement(const string& source, int line) {
+    OutputSink& output = OutputSink::standardOutput();
+    EngineOutput print = [&output](const char* data, size_t length) {
+        output.write(data, length);
+    };
+
+    shared_ptr<EngineProgram> program;
+    EngineResult result = engine.compile(source, session.get(), &program);
+    if (result.succeeded()) {
+        result = engine.run(program, session.get(), print);
+    }
+
+    if (!result.succeeded()) {
+        //Print the output of the statement before its error, so they appear in order
+        output.flush();
+        cerr << offsetLine(result.error, line) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Checks if the statements entered so far are complete, with every bracket closed and the last ending with ; or }.
+ * Sets empty if the source only holds whitespace and comments, and endsWithBlock if the last statement ends with }.
+ */
+bool Repl::isComplete(const string& source, bool* empty, bool* endsWithBlock) {
+    string rest;
+    vector<StatementText> statements = splitStatements(source, &rest);
+
+    *empty = statements.empty() && rest.empty();
+    *endsWithBlock = rest.empty() && !statements.empty() && statements.back().text.back() == '}';
+    return rest.empty();
+}
+
+
+/*
+ * Checks if the first token of a line is else. Sets blank if the line only holds whitespace and comments.
+ */
+bool Repl::startsWithElse(const string& line, bool* blank) {
+    string rest;
+    vector<StatementText> statements = splitStatements(line, &rest);
+
+    *blank = statements.empty() && rest.empty();
+
+    const string& first = statements.empty() ? rest : statements.front().text;
+    return first.compare(0, 4, "else") == 0 &&
+           (first.size() == 4 || !(isalnum((unsigned char) first[4]) || first[4] == '_'));
+}
@@ -0,0 +1,46 @@
+#ifndef CPS2000_ASSIGNMENT_REPL_H
+#define CPS2000_ASSIGNMENT_REPL_H
+
+#include <istream>
+#include <memory>
+#include <string>
+#include "Script.h"
+#include "../Engine/Engine.h"
+
+#define REPL_PROMPT "> "            //Printed before each statement when reading from a terminal
+#define REPL_CONTINUATION "... "    //Printed before each further line of a statement which is not complete
+
+using namespace std;
+
+
+/*
+ * Reads statements one at a time and runs each as soon as it is complete, in a session which keeps the globals
+ * declared by earlier statements in both the semantic and the interpreter's symbol tables.
+ * Each statement is compiled and run on its own, so earlier input is never processed again and the time taken
+ * by a statement does not depend on how many came before it.
+ *
+ * A statement is complete once its brackets are closed and it ends with ; or }, so a function can be entered
+ * over several lines. A statement with an error is reported and discarded, and the session carries on.
+ * When the input is not a terminal, a statement ending with } is held until the next token shows whether an else
+ * follows, so piped input splits into the same statements as a file. Typed input runs it at once.
+ */
+class Repl {
+public:
+    explicit Repl(const RunOptions& options);
+
+    int run(istream& in);
+
+
+private:
+    Engine engine;
+    shared_ptr<EngineSession> session;
+    bool interactive;   //True if reading from a terminal, when prompts are printed and output is flushed after each statement
+
+    bool runStatement(const string& source, int line);
+    static bool isComplete(const string& source, bool* empty, bool* endsWithBlock);
+    static bool startsWithElse(const string& line, bool* blank);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_REPL_H
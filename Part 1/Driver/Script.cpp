@@ -0,0 +1,78 @@
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include "Script.h"
+#include "../Parser/Parser.h"
+#include "../Visitor/IntepreterVisitor.h"
+#include "../Visitor/JITVisitor.h"
+#include "../Visitor/OptimiserVisitor.h"
+#include "../Visitor/SemanticVisitor.h"
+
+
+/*
+ * Reads a script in the same way as main, ending every line with a newline.
+ */
+string readScript(const string& fileName) {
+    ifstream f(fileName);
+
+    if (!f.is_open()) {
+        throw runtime_error("File " + fileName + " could not be opened.");
+    }
+
+    string source;
+    string line;
+    while (getline(f, line)) {
+        source.append(line);
+        source.append("\n");
+    }
+
+    return source;
+}
+
+
+/*
+ * Parses, checks and optimises a script, returning a program ready to run.
+ * A caller which frees its programs can give each string literal its own buffer, rather than interning them for
+ * the life of the process.
+ */
+ASTProgram* compileScript(const string& source, const RunOptions& options, bool internStrings) {
+    string program = source;
+    Parser parser(&program);
+    parser.setInternStrings(internStrings);
+    ASTProgram* node = parser.parseProgram();
+
+    //Free the program if it is not valid, as the caller only gets a program which can run
+    SemanticVisitor semantic;
+    try {
+        node->accept(&semantic);
+    }
+    catch (runtime_error&) {
+        delete node;
+        throw;
+    }
+
+    if (options.optimise) {
+        OptimiserVisitor optimiser(options.unrollFactor);
+        node->accept(&optimiser);
+    }
+
+    return node;
+}
+
+
+/*
+ * Runs a compiled program with a new interpreter, writing its output to a sink.
+ * The sink is not finished, so the caller can still flush it after an error.
+ */
+void runScript(ASTProgram* program, OutputSink* output, const RunOptions& options) {
+    unique_ptr<Governor> governor(options.limits.isLimited() ? new Governor(options.limits) : nullptr);
+    bool useJIT = options.useJIT && governor == nullptr;
+    unique_ptr<JITVisitor> jit(useJIT ? new JITVisitor(options.jitThreshold, options.osrThreshold) : nullptr);
+
+    InterpreterVisitor interpreter(jit.get());
+    interpreter.setGovernor(governor.get());
+    interpreter.setSuperinstructions(options.superinstructions);
+    interpreter.setOutput(output);
+
+    program->accept(&interpreter);
+}
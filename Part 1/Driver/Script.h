@@ -0,0 +1,37 @@
+#ifndef CPS2000_ASSIGNMENT_SCRIPT_H
+#define CPS2000_ASSIGNMENT_SCRIPT_H
+
+#include <string>
+#include "../AST/AST.h"
+#include "../Runtime/Governor.h"
+#include "../Runtime/OutputSink.h"
+
+using namespace std;
+
+
+/*
+ * How a script is checked and run, when it is not run directly by main.
+ */
+struct RunOptions {
+    bool optimise;
+    int unrollFactor;
+    bool superinstructions;
+    bool useJIT;
+    int jitThreshold;
+    int osrThreshold;
+    GovernorLimits limits;      //A limited script is always interpreted, as the JIT does not count its operations
+};
+
+
+/*
+ * The stages shared by the drivers which run many scripts in one process.
+ * Each call uses its own lexer, parser and visitors, so scripts can be compiled and run on several threads.
+ * Errors in the script are thrown as runtime_error.
+ */
+string readScript(const string& fileName);
+ASTProgram* compileScript(const string& source, const RunOptions& options, bool internStrings = true);
+void runScript(ASTProgram* program, OutputSink* output, const RunOptions& options);
+
+
+
+#endif //CPS2000_ASSIGNMENT_SCRIPT_H
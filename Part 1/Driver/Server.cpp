@@ -0,0 +1,214 @@
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "Protocol.h"
+#include "Server.h"
+#include "../Binary/CompileCache.h"
+
+
+Server::Server(const string& socketPath, const RunOptions& options) {
+    this->socketPath = socketPath;
+    this->options = options;
+    this->clock = 0;
+}
+
+Server::~Server() {
+    for (auto& entry : cache) {
+        for (ASTProgram* program : entry.second.idle) {
+            delete program;
+        }
+    }
+}
+
+
+/*
+ * Listens on the socket and handles connections until the process is stopped.
+ * Returns an error status if the socket could not be created.
+ */
+int Server::run() {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        cerr << "Socket path " << socketPath << " is too long" << endl;
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath.c_str());
+
+    //A client which goes away must not stop the server when its output is written
+    signal(SIGPIPE, SIG_IGN);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str());
+
+    if (listener < 0 || bind(listener, (sockaddr*) &address, sizeof(address)) != 0
+        || listen(listener, SERVER_BACKLOG) != 0) {
+        cerr << "Socket " << socketPath << " could not be opened: " << strerror(errno) << endl;
+        return 1;
+    }
+
+    //Each thread accepts its own connections, so no more than SERVER_THREADS are handled at once
+    vector<thread> workers;
+    for (int i = 0; i < SERVER_THREADS; i++) {
+        workers.emplace_back(&Server::serve, this, listener);
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+    return 1;
+}
+
+
+/*
+ * Accepts and handles connections one at a time, until the socket fails.
+ */
+void Server::serve(int listener) {
+    while (true) {
+        int connection = accept(listener, nullptr, nullptr);
+
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            cerr << "Connection could not be accepted: " << strerror(errno) << endl;
+            return;
+        }
+
+        handle(connection);
+    }
+}
+
+
+/*
+ * Runs the script sent over a connection, sending back its output, any error and its exit status.
+ */
+void Server::handle(int connection) {
+    string source;
+    int status = 0;
+    string error;
+
+    if (receiveAll(connection, &source, SERVER_MAX_SCRIPT, SERVER_RECEIVE_TIMEOUT)) {
+        uint64_t hash = CompileCache::hash(source);
+        ASTProgram* program = nullptr;
+
+        //Output is sent as it is flushed, each block in its own frame
+        OutputSink output(connection, FLUSH_FULL);
+        output.setTarget([connection](const char* data, size_t length) {
+            writeFrame(connection, FRAME_OUTPUT, data, length);
+        });
+
+        try {
+            program = take(source, hash);
+            if (program == nullptr) {
+                program = compileScript(source, options, false);
+            }
+
+            runScript(program, &output, options);
+        }
+        catch (exception& e) {
+            status = 1;
+            error = e.what();
+        }
+
+        output.finish();
+
+        //A program which failed to compile is not cached, but one which failed while running can be run again
+        if (program != nullptr) {
+            give(source, hash, program);
+        }
+    }
+    else if (source.size() > SERVER_MAX_SCRIPT) {
+        status = 1;
+        error = "The script is longer than " + to_string(SERVER_MAX_SCRIPT) + " bytes.";
+    }
+    else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        status = 1;
+        error = "The script was not sent within " + to_string(SERVER_RECEIVE_TIMEOUT) + " seconds.";
+    }
+    else {
+        status = 1;
+        error = "The script could not be read.";
+    }
+
+    if (!error.empty()) {
+        writeFrame(connection, FRAME_ERROR, error.data(), error.size());
+    }
+
+    string text = to_string(status);
+    writeFrame(connection, FRAME_STATUS, text.data(), text.size());
+
+    close(connection);
+}
+
+
+/*
+ * Takes a compiled copy of a script from the cache, or returns null if there is none which is not running.
+ */
+ASTProgram* Server::take(const string& source, uint64_t hash) {
+    lock_guard<mutex> guard(cacheLock);
+
+    auto found = cache.find(hash);
+    if (found == cache.end() || found->second.source != source) {
+        return nullptr;
+    }
+
+    found->second.used = ++clock;
+    if (found->second.idle.empty()) {
+        return nullptr;
+    }
+
+    ASTProgram* program = found->second.idle.back();
+    found->second.idle.pop_back();
+    return program;
+}
+
+
+/*
+ * Returns a compiled program to the cache once it has finished running, making room for its script if needed.
+ * A program whose hash is taken by a different script is freed instead.
+ */
+void Server::give(const string& source, uint64_t hash, ASTProgram* program) {
+    lock_guard<mutex> guard(cacheLock);
+
+    auto found = cache.find(hash);
+    if (found == cache.end()) {
+        if (cache.size() >= SERVER_CACHE_PROGRAMS) {
+            evict();
+        }
+        found = cache.emplace(hash, CachedProgram{source, {}, ++clock}).first;
+    }
+
+    if (found->second.source != source) {
+        delete program;
+        return;
+    }
+
+    found->second.idle.push_back(program);
+}
+
+
+/*
+ * Frees the programs of the least recently used script and forgets it. Copies of it which are running are
+ * added back to the cache when they finish. Called with the cache locked.
+ */
+void Server::evict() {
+    auto oldest = cache.begin();
+    for (auto entry = cache.begin(); entry != cache.end(); ++entry) {
+        if (entry->second.used < oldest->second.used) {
+            oldest = entry;
+        }
+    }
+
+    for (ASTProgram* program : oldest->second.idle) {
+        delete program;
+    }
+    cache.erase(oldest);
+}
@@ -0,0 +1,67 @@
+#ifndef CPS2000_ASSIGNMENT_SERVER_H
+#define CPS2000_ASSIGNMENT_SERVER_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Script.h"
+
+#define SERVER_BACKLOG 64           //Connections waiting to be accepted before new ones are refused
+#define SERVER_CACHE_PROGRAMS 256   //Different scripts kept compiled, the least recently used are freed beyond this
+#define SERVER_THREADS 16           //Connections handled at once, later ones wait to be accepted
+#define SERVER_MAX_SCRIPT (1 << 24) //Bytes of source accepted in one script
+#define SERVER_RECEIVE_TIMEOUT 10   //Seconds a client has to send the whole of its script
+
+using namespace std;
+
+
+/*
+ * A long running process which runs scripts sent to it over a Unix domain socket, so each script avoids
+ * starting a process and building the lexer's tables. The protocol is described in Protocol.h.
+ *
+ * Connections are handled by a fixed pool of SERVER_THREADS threads, each with its own interpreter, symbol table
+ * and output for the connection it is handling. Connections beyond that wait in the socket's backlog.
+ * Checked and optimised programs are kept by a hash of their source, so a script sent again is run without
+ * being compiled. A program records what the interpreter learns about it while it runs, so a cached program
+ * is only lent to one request at a time: a request for a script which is already running compiles its own
+ * copy, which is added to the cache when it is done. Once SERVER_CACHE_PROGRAMS scripts are cached, the least
+ * recently used script's programs are freed, and a program which is not cached is freed once it has run.
+ * A script longer than SERVER_MAX_SCRIPT bytes, or not sent within SERVER_RECEIVE_TIMEOUT seconds, is refused,
+ * so clients which send too much or nothing at all cannot take the memory or the threads of the server.
+ * String literals are not interned, so they are freed with their programs however long the server runs.
+ */
+class Server {
+public:
+    Server(const string& socketPath, const RunOptions& options);
+    ~Server();
+
+    int run();
+
+
+private:
+    //The compiled copies of one script which are not running
+    struct CachedProgram {
+        string source;                  //Compared on every lookup, so scripts with the same hash are never mixed up
+        vector<ASTProgram*> idle;
+        long long used;                 //When the script was last requested, by the cache's clock
+    };
+
+    string socketPath;
+    RunOptions options;
+
+    mutex cacheLock;
+    map<uint64_t, CachedProgram> cache;
+    long long clock;                    //Counts requests, to find the least recently used script
+
+    void serve(int listener);
+    void handle(int connection);
+    ASTProgram* take(const string& source, uint64_t hash);
+    void give(const string& source, uint64_t hash, ASTProgram* program);
+    void evict();
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_SERVER_H
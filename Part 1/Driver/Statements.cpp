@@ -0,0 +1,121 @@
+#include <cctype>
+#include "Statements.h"
+
+
+/*
+ * True if the word starts at a position in the source, and is not just the start of a longer identifier.
+ */
+static bool startsWord(const string& source, size_t i, const string& word) {
+    size_t end = i + word.size();
+    return source.compare(i, word.size(), word) == 0 &&
+           (end == source.size() || !(isalnum((unsigned char) source[end]) || source[end] == '_'));
+}
+
+
+vector<StatementText> splitStatements(const string& source, string* rest) {
+    vector<StatementText> statements;
+
+    int depth = 0;                  //Brackets and braces which are open
+    int line = 1;
+    size_t start = string::npos;    //Where the current statement starts, npos between statements
+    int startLine = 1;
+    size_t closed = string::npos;   //The end of a statement which ended with }, kept open in case an else follows
+    size_t open = string::npos;     //A string or comment which is never closed
+
+    for (size_t i = 0; i < source.size() && open == string::npos; i++) {
+        char c = source[i];
+        char next = i + 1 < source.size() ? source[i + 1] : '\0';
+
+        if (c == '\n') {
+            line++;
+            continue;
+        }
+        if (isspace((unsigned char) c)) {
+            continue;
+        }
+
+        //Skip comments, counting the lines in them
+        if (c == '/' && next == '/') {
+            while (i + 1 < source.size() && source[i + 1] != '\n') {
+                i++;
+            }
+            continue;
+        }
+        if (c == '/' && next == '*') {
+            size_t end = source.find("*/", i + 2);
+            if (end == string::npos) {
+                open = i;
+                break;
+            }
+
+            for (; i < end + 1; i++) {
+                line += source[i] == '\n';
+            }
+            continue;
+        }
+
+        //A statement closed by a block only ends once we know no else follows
+        if (closed != string::npos) {
+            if (startsWord(source, i, "else")) {
+                closed = string::npos;
+            }
+            else {
+                statements.push_back(StatementText{source.substr(start, closed - start), startLine});
+                start = string::npos;
+                closed = string::npos;
+            }
+        }
+
+        if (start == string::npos) {
+            start = i;
+            startLine = line;
+        }
+
+        if (c == '"') {
+            size_t end = source.find('"', i + 1);
+            if (end == string::npos) {
+                open = i;
+                break;
+            }
+
+            for (; i < end; i++) {
+                line += source[i] == '\n';
+            }
+        }
+        else if (c == '{' || c == '(') {
+            depth++;
+        }
+        else if (c == '}' || c == ')') {
+            depth = depth > 0 ? depth - 1 : 0;
+            if (c == '}' && depth == 0) {
+                closed = i + 1;
+            }
+        }
+        else if (c == ';' && depth == 0) {
+            statements.push_back(StatementText{source.substr(start, i + 1 - start), startLine});
+            start = string::npos;
+        }
+    }
+
+    if (closed != string::npos && open == string::npos) {
+        statements.push_back(StatementText{source.substr(start, closed - start), startLine});
+        start = string::npos;
+    }
+
+    //The statement which is not complete, or the string or comment which is never closed
+    size_t from = start != string::npos ? start : open;
+    *rest = from != string::npos ? source.substr(from) : "";
+
+    return statements;
+}
+
+
+string offsetLine(const string& error, int line) {
+    if (error.compare(0, 5, "Line ") != 0) {
+        return error;
+    }
+
+    size_t end;
+    int errorLine = stoi(error.substr(5), &end);
+    return "Line " + to_string(errorLine + line - 1) + error.substr(5 + end);
+}
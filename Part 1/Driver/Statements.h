@@ -0,0 +1,36 @@
+#ifndef CPS2000_ASSIGNMENT_STATEMENTS_H
+#define CPS2000_ASSIGNMENT_STATEMENTS_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * The source of one top level statement, and the line of the file it starts on.
+ */
+struct StatementText {
+    string text;
+    int line;
+};
+
+
+/*
+ * Splits source into its top level statements without parsing it, for the drivers which handle statements
+ * one at a time. A statement ends with a ; outside any brackets, or with the } which closes its last block
+ * unless an else follows. Comments between statements are dropped, strings and comments are never split.
+ * Whatever follows the last complete statement is returned in rest, which is empty if nothing does.
+ */
+vector<StatementText> splitStatements(const string& source, string* rest);
+
+
+/*
+ * Errors give the line within the source they were found in, this moves them to a line of a larger file
+ * which the source starts on.
+ */
+string offsetLine(const string& error, int line);
+
+
+
+#endif //CPS2000_ASSIGNMENT_STATEMENTS_H
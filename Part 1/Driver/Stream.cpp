@@ -0,0 +1,115 @@
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <sys/resource.h>
+#include "Stream.h"
+#include "../Parser/Parser.h"
+#include "../Visitor/IntepreterVisitor.h"
+#include "../Visitor/OptimiserVisitor.h"
+#include "../Visitor/SemanticVisitor.h"
+
+
+Stream::Stream(const string& fileName, const RunOptions& options, bool runProgram) {
+    this->fileName = fileName;
+    this->options = options;
+    this->runProgram = runProgram;
+    this->statements = 0;
+    this->milliseconds = 0;
+}
+
+Stream::~Stream() {
+    for (ASTStatement* function : functions) {
+        delete function;
+    }
+}
+
+
+/*
+ * Reads, checks and runs each statement in turn, until the end of the file, a return outside of any function
+ * or an error. Returns 1 if there was an error, like a script run in full, or 0 otherwise.
+ */
+int Stream::run() {
+    auto start = chrono::steady_clock::now();
+
+    ifstream input(fileName);
+    if (!input.is_open()) {
+        cerr << "File " << fileName << " could not be opened." << endl;
+        return 1;
+    }
+
+    OutputSink& output = OutputSink::standardOutput();
+
+    //Both tables keep one global scope for the whole script, as each statement is visited on its own
+    SemanticVisitor semantic;
+    semantic.getTable()->push();
+
+    unique_ptr<Governor> governor(options.limits.isLimited() ? new Governor(options.limits) : nullptr);
+    InterpreterVisitor interpreter;
+    interpreter.setSuperinstructions(options.superinstructions);
+    interpreter.setOutput(&output);
+    interpreter.setGovernor(governor.get());
+    interpreter.getTable()->push();
+
+    OptimiserVisitor optimiser(options.unrollFactor);
+    int status = 0;
+
+    try {
+        Parser parser(&input);
+        parser.setInternStrings(false);
+
+        ASTStatement* statement;
+        while ((statement = parser.parseNextStatement()) != nullptr) {
+            statements++;
+
+            //Held in a program so it is freed after it runs or has an error, and so the optimiser can replace it
+            ASTProgram holder({statement}, statement->lineNum);
+            statement->accept(&semantic);
+
+            if (options.optimise) {
+                holder.accept(&optimiser);
+                statement = holder.program[0];
+            }
+
+            if (runProgram) {
+                statement->accept(&interpreter);
+            }
+
+            if (dynamic_cast<ASTFunctionDecl*>(statement) != nullptr) {
+                functions.push_back(statement);
+                holder.program.clear();
+            }
+
+            if (interpreter.isReturning()) {
+                break;
+            }
+        }
+    }
+    catch (runtime_error& e) {
+        //Keep everything printed before the error
+        output.flush();
+        cerr << e.what() << endl;
+        status = 1;
+    }
+
+    output.flush();
+    interpreter.getTable()->unwind(0);
+    milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    return status;
+}
+
+
+/*
+ * Reports how many statements were streamed, how long it took and the most memory the process has held.
+ */
+void Stream::printSummary(ostream& out) {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+    out << "Streamed " << statements << " statements, keeping " << functions.size() << " functions, in "
+        << fixed << setprecision(3) << milliseconds << " ms, peak RSS " << setprecision(1)
+        << (double) usage.ru_maxrss / 1024 << " MiB" << endl;
+}
@@ -0,0 +1,46 @@
+#ifndef CPS2000_ASSIGNMENT_STREAM_H
+#define CPS2000_ASSIGNMENT_STREAM_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Script.h"
+
+using namespace std;
+
+
+/*
+ * Parses, checks and runs a script one top level statement at a time, reading the file as it goes, so a script
+ * starts running at once and its length does not limit the memory it needs.
+ *
+ * Each statement is freed once it has run, except function declarations, which later statements may call.
+ * The lexer only keeps the characters from its current token onwards, and string literals get their own buffers
+ * rather than being interned for the life of the process, so memory depends on the largest statement, the
+ * functions declared and the values of the globals rather than on the length of the file.
+ *
+ * Unlike a script checked in full before it runs, the statements before an error have already run when it is found.
+ * The JIT knows loops by their address, which a later statement could reuse once a loop is freed, so a streamed
+ * script is always interpreted.
+ */
+class Stream {
+public:
+    Stream(const string& fileName, const RunOptions& options, bool runProgram);
+    ~Stream();
+
+    int run();
+    void printSummary(ostream& out);
+
+
+private:
+    string fileName;
+    RunOptions options;
+    bool runProgram;                    //False if the statements are only checked
+
+    vector<ASTStatement*> functions;    //Function declarations, kept as later statements may call them
+    long long statements;               //Top level statements read so far
+    double milliseconds;                //Time taken to read, check and run the script
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_STREAM_H
@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "Watch.h"
+#include "../Parser/Parser.h"
+#include "../Visitor/CloneVisitor.h"
+#include "../Visitor/OptimiserVisitor.h"
+#include "../Visitor/SemanticVisitor.h"
+
+
+//Milliseconds since a point in time
+static double millisecondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+
+Watch::Watch(const string& fileName, const RunOptions& options, bool runProgram, bool compare) {
+    this->fileName = fileName;
+    this->options = options;
+    this->runProgram = runProgram;
+    this->compare = compare;
+    this->firstBuild = 0;
+}
+
+Watch::~Watch() {
+    for (auto& statement : parsed) {
+        delete statement.second;
+    }
+}
+
+
+/*
+ * Builds the script, then waits for it to change and builds it again, until the process is stopped.
+ * Only returns if the file cannot be watched.
+ */
+int Watch::run() {
+    //Editors often save by replacing the file, which would end a watch on the file itself, so its directory is watched
+    size_t slash = fileName.rfind('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : fileName.substr(0, slash);
+    string name = slash == string::npos ? fileName : fileName.substr(slash + 1);
+
+    int notify = inotify_init1(IN_CLOEXEC);
+    if (notify < 0 || inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        cerr << "Could not watch " << fileName << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    rebuild(true);
+
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(notify, buffer, sizeof(buffer));
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            cerr << "Could not watch " << fileName << ": " << strerror(errno) << endl;
+            close(notify);
+            return 1;
+        }
+
+        bool changed = false;
+        for (char* next = buffer; next < buffer + length;) {
+            auto event = (inotify_event*) next;
+            changed = changed || (event->len > 0 && name == event->name);
+            next += sizeof(inotify_event) + event->len;
+        }
+
+        if (changed) {
+            //Wait until the file stops changing
+            pollfd waiting = {notify, POLLIN, 0};
+            while (poll(&waiting, 1, WATCH_SETTLE_MS) > 0 && read(notify, buffer, sizeof(buffer)) > 0) {}
+
+            rebuild(false);
+        }
+    }
+}
+
+
+/*
+ * Parses and checks the statements which need it, reports how long it took, then runs the script if it is valid.
+ */
+void Watch::rebuild(bool first) {
+    auto start = chrono::steady_clock::now();
+    vector<StatementText> statements;
+    int parsedCount = 0;
+    int checkedCount = 0;
+    double milliseconds;
+    double full = 0;
+
+    try {
+        string source = readScript(fileName);
+        string rest;
+        statements = splitStatements(source, &rest);
+
+        //An incomplete statement at the end is parsed on its own, so the parser reports what is missing
+        if (!rest.empty()) {
+            int line = 1 + (int) count(source.begin(), source.end() - (long) rest.size(), '\n');
+            statements.push_back(StatementText{rest, line});
+        }
+
+        parse(statements, &parsedCount);
+        check(statements, &checkedCount);
+        milliseconds = millisecondsSince(start);
+
+        if (compare) {
+            full = buildInFull();
+        }
+    }
+    catch (runtime_error& e) {
+        cerr << e.what() << endl;
+        return;
+    }
+
+    if (first) {
+        firstBuild = milliseconds;
+    }
+
+    cerr << (first ? "Built " : "Rebuilt ") << fileName << " in " << fixed << setprecision(3) << milliseconds
+         << " ms, parsed " << parsedCount << " and checked " << checkedCount << " of " << statements.size()
+         << " statements";
+    if (!first) {
+        cerr << " (first build " << firstBuild << " ms)";
+    }
+    if (compare) {
+        cerr << ", full build " << full << " ms";
+    }
+    cerr << endl;
+
+    if (runProgram) {
+        execute(statements);
+    }
+}
+
+
+/*
+ * Parses each statement which was not in the last version of the script, and forgets those which were removed.
+ * Statements are parsed on their own, so their line numbers start from 1.
+ */
+void Watch::parse(const vector<StatementText>& statements, int* parsedCount) {
+    map<string, ASTProgram*> current;
+    string error;
+
+    for (const StatementText& statement : statements) {
+        if (current.count(statement.text) > 0) {
+            continue;
+        }
+
+        auto old = parsed.find(statement.text);
+        if (old != parsed.end()) {
+            current.insert(*old);
+            parsed.erase(old);
+            continue;
+        }
+
+        try {
+            string text = statement.text + "\n";
+            Parser parser(&text);
+            current[statement.text] = parser.parseProgram();
+            (*parsedCount)++;
+        }
+        catch (runtime_error& e) {
+            error = offsetLine(e.what(), statement.line);
+            break;
+        }
+    }
+
+    if (!error.empty()) {
+        //Keep everything parsed so far, the statements after the error are likely to be unchanged
+        parsed.insert(current.begin(), current.end());
+        throw runtime_error(error);
+    }
+
+    for (auto& removed : parsed) {
+        delete removed.second;
+    }
+    parsed = current;
+}
+
+
+/*
+ * Checks the statements in order against the globals declared before them. A statement which is unchanged and
+ * looks up the same globals as before cannot have a new error, so only its declarations are added.
+ */
+void Watch::check(const vector<StatementText>& statements, int* checkedCount) {
+    SemanticVisitor semantic;
+    SymbolTable* table = semantic.getTable();
+    table->push();
+
+    map<pair<string, int>, CheckedStatement> current;
+    map<string, int> copies;
+
+    for (const StatementText& statement : statements) {
+        pair<string, int> key(statement.text, copies[statement.text]++);
+        ASTProgram* program = parsed[statement.text];
+
+        auto old = checked.find(key);
+        bool unchanged = old != checked.end();
+        if (unchanged) {
+            for (auto& global : old->second.globals) {
+                if (table->describeGlobal(global.first) != global.second) {
+                    unchanged = false;
+                    break;
+                }
+            }
+        }
+
+        if (unchanged) {
+            for (ASTStatement* node : program->program) {
+                if (auto variable = dynamic_cast<ASTVariableDecl*>(node)) {
+                    table->declare(variable);
+                }
+                else if (auto function = dynamic_cast<ASTFunctionDecl*>(node)) {
+                    table->declare(function);
+                }
+            }
+
+            current[key] = old->second;
+            continue;
+        }
+
+        CheckedStatement record;
+        table->setLookupLog(&record.globals);
+
+        try {
+            for (ASTStatement* node : program->program) {
+                node->accept(&semantic);
+            }
+        }
+        catch (runtime_error& e) {
+            //Keep what was learnt about the statements before the error, the one with the error is checked again
+            table->setLookupLog(nullptr);
+            checked.erase(key);
+            for (auto& statementChecked : current) {
+                checked[statementChecked.first] = statementChecked.second;
+            }
+
+            throw runtime_error(offsetLine(e.what(), statement.line));
+        }
+
+        table->setLookupLog(nullptr);
+        current[key] = record;
+        (*checkedCount)++;
+    }
+
+    checked = current;
+}
+
+
+/*
+ * Runs a copy of the statements as one program, with each statement moved to its line in the file.
+ */
+void Watch::execute(const vector<StatementText>& statements) {
+    vector<ASTStatement*> program;
+
+    for (const StatementText& statement : statements) {
+        CloneVisitor cloner;
+        cloner.setLineOffset(statement.line - 1);
+
+        for (ASTStatement* node : parsed[statement.text]->program) {
+            program.push_back(cloner.clone(node));
+        }
+    }
+
+    auto node = new ASTProgram(program, 1);
+    OutputSink& output = OutputSink::standardOutput();
+
+    try {
+        if (options.optimise) {
+            OptimiserVisitor optimiser(options.unrollFactor);
+            node->accept(&optimiser);
+        }
+
+        runScript(node, &output, options);
+    }
+    catch (runtime_error& e) {
+        output.flush();
+        cerr << e.what() << endl;
+    }
+
+    output.flush();
+    delete node;
+}
+
+
+/*
+ * Reads, parses and checks the whole script from scratch, as it is built without watching.
+ * Returns the milliseconds taken.
+ */
+double Watch::buildInFull() {
+    auto start = chrono::steady_clock::now();
+
+    string source = readScript(fileName);
+    Parser parser(&source);
+    ASTProgram* program = parser.parseProgram();
+
+    SemanticVisitor semantic;
+    program->accept(&semantic);
+
+    double milliseconds = millisecondsSince(start);
+    delete program;
+    return milliseconds;
+}
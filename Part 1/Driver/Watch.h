@@ -0,0 +1,61 @@
+#ifndef CPS2000_ASSIGNMENT_WATCH_H
+#define CPS2000_ASSIGNMENT_WATCH_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Script.h"
+#include "Statements.h"
+
+#define WATCH_SETTLE_MS 50      //Time to wait for further changes after a file changes, as editors often save in several steps
+
+using namespace std;
+
+
+/*
+ * Rebuilds a script whenever it changes on disk, then runs it, until stopped.
+ *
+ * The script is split into its top level statements, which are parsed on their own and kept by their text,
+ * so a rebuild only parses the statements which changed. Each statement remembers the globals it looked up
+ * when it was last checked, and is only checked again if it changed or one of those globals was declared
+ * with a different type or parameters. Otherwise its declarations are added to the symbol table without
+ * visiting it. The run uses a copy of the statements, as the optimiser and interpreter change the tree.
+ *
+ * Each rebuild reports how long it took and how many statements it parsed and checked, next to the time
+ * taken by the first build, which parsed and checked every statement. When comparing, each version of the
+ * script is also built in full, as it would be without watching, and the time taken is reported as well.
+ */
+class Watch {
+public:
+    Watch(const string& fileName, const RunOptions& options, bool runProgram, bool compare);
+    ~Watch();
+
+    int run();
+
+
+private:
+    //What a statement looked up the last time it was checked
+    struct CheckedStatement {
+        map<string, string> globals;    //Each identifier looked up, and the global it named then
+    };
+
+    string fileName;
+    RunOptions options;
+    bool runProgram;
+    bool compare;               //True if each version is also built in full, to compare the times taken
+    double firstBuild;          //Milliseconds taken by the first build, which parsed and checked every statement
+
+    map<string, ASTProgram*> parsed;                        //Each statement parsed on its own, by its text
+    map<pair<string, int>, CheckedStatement> checked;       //By text, and which copy of the text it is
+
+    void rebuild(bool first);
+    void parse(const vector<StatementText>& statements, int* parsedCount);
+    void check(const vector<StatementText>& statements, int* checkedCount);
+    void execute(const vector<StatementText>& statements);
+    double buildInFull();
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_WATCH_H
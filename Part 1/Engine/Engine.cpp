@@ -0,0 +1,262 @@
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include "Engine.h"
+#include "../Driver/Script.h"
+#include "../Parser/Parser.h"
+#include "../Visitor/IntepreterVisitor.h"
+#include "../Visitor/JITVisitor.h"
+#include "../Visitor/OptimiserVisitor.h"
+#include "../Visitor/SemanticVisitor.h"
+
+
+//The limits on each run, as the governor takes them
+static GovernorLimits limitsOf(const EngineOptions& options) {
+    return GovernorLimits{options.maxOperations, options.maxMilliseconds, options.maxDepth, options.maxBytes};
+}
+
+
+/*
+ * A compiled program, with the globals it declares so they can be added to a session when it runs there.
+ */
+class EngineProgram {
+public:
+    ASTProgram* node;
+    Scope declarations;     //The types of the globals declared by the program
+    long long session;      //The session the program was checked in, 0 if it was checked on its own
+    long long generation;   //The generation of the session's globals the program was checked against
+    bool declaresFunctions; //True if a session's globals may point to the program's functions once it has run
+
+    EngineProgram() {
+        this->node = nullptr;
+        this->session = 0;
+        this->generation = 0;
+        this->declaresFunctions = false;
+    }
+
+    ~EngineProgram() {
+        delete node;
+    }
+};
+
+
+/*
+ * The globals kept between programs. The semantic table holds their types, for checking the programs compiled in
+ * the session, and the interpreter's table holds their values. Each keeps the globals in a scope below the programs.
+ * The generation increases whenever the types of the globals change, as programs checked before then may
+ * no longer be valid.
+ */
+class EngineSession {
+public:
+    long long id;
+    long long generation;
+    SemanticVisitor semantic;
+    unique_ptr<JITVisitor> jit;
+    InterpreterVisitor interpreter;
+    set<shared_ptr<EngineProgram>> programs;    //Programs whose functions were added to the session's globals, or all with the JIT
+
+    EngineSession(long long id, const EngineOptions& options) :
+            jit(options.useJIT && !limitsOf(options).isLimited() ? new JITVisitor(options.jitThreshold, options.osrThreshold) : nullptr),
+            interpreter(jit.get()) {
+        this->id = id;
+        this->generation = 0;
+
+        semantic.setRetainGlobals(true);
+        semantic.getTable()->push();
+
+        interpreter.setRetainGlobals(true);
+        interpreter.setSuperinstructions(options.superinstructions);
+        interpreter.getTable()->push();
+    }
+
+    ~EngineSession() {
+        //Free the values of the globals
+        interpreter.getTable()->unwind(0);
+    }
+};
+
+
+static atomic<long long> nextSession(1);
+
+
+
+EngineOptions::EngineOptions() {
+    this->optimise = true;
+    this->unrollFactor = DEFAULT_UNROLL_FACTOR;
+    this->superinstructions = true;
+    this->useJIT = false;
+    this->jitThreshold = DEFAULT_JIT_THRESHOLD;
+    this->osrThreshold = DEFAULT_OSR_THRESHOLD;
+    this->maxOperations = 0;
+    this->maxMilliseconds = 0;
+    this->maxDepth = 0;
+    this->maxBytes = 0;
+}
+
+
+bool EngineResult::succeeded() const {
+    return status == 0;
+}
+
+
+Engine::Engine() = default;
+
+Engine::Engine(const EngineOptions& options) {
+    this->options = options;
+}
+
+
+/*
+ * Creates a session with no globals.
+ */
+shared_ptr<EngineSession> Engine::createSession() {
+    return make_shared<EngineSession>(nextSession++, options);
+}
+
+
+/*
+ * Compiles a program which does not use any globals from a session.
+ */
+EngineResult Engine::compile(const string& source, shared_ptr<EngineProgram>* program) {
+    return compile(source, nullptr, program);
+}
+
+
+/*
+ * Parses, checks and optimises a program, checking it against the globals of a session if one is given.
+ * The program is only set if it compiled.
+ */
+EngineResult Engine::compile(const string& source, EngineSession* session, shared_ptr<EngineProgram>* program) {
+    SemanticVisitor standalone;
+    standalone.setRetainGlobals(true);
+
+    SemanticVisitor* semantic = session != nullptr ? &session->semantic : &standalone;
+    SymbolTable* table = semantic->getTable();
+    size_t depth = table->getDepth();
+
+    auto compiled = make_shared<EngineProgram>();
+    try {
+        string text = source;
+        //Literals are freed with the program rather than interned, as a library may compile any number of programs
+        Parser parser(&text);
+        parser.setInternStrings(false);
+        compiled->node = parser.parseProgram();
+        compiled->node->accept(semantic);
+
+        //The session's globals only change when the program runs, so its declarations are kept until then
+        compiled->declarations = *table->top();
+        table->unwind(depth);
+
+        for (auto& symbol : compiled->declarations) {
+            compiled->declaresFunctions = compiled->declaresFunctions || !symbol.second.func.empty();
+        }
+
+        if (options.optimise) {
+            OptimiserVisitor optimiser(options.unrollFactor);
+            compiled->node->accept(&optimiser);
+        }
+    }
+    catch (exception& e) {
+        table->unwind(depth);
+        return EngineResult{1, e.what()};
+    }
+
+    if (session != nullptr) {
+        compiled->session = session->id;
+        compiled->generation = session->generation;
+    }
+
+    *program = compiled;
+    return EngineResult{0, ""};
+}
+
+
+/*
+ * Runs a program with no globals, passing its output to a callback.
+ */
+EngineResult Engine::run(const shared_ptr<EngineProgram>& program, const EngineOutput& output) {
+    if (program->session != 0) {
+        return EngineResult{1, "The program was compiled in a session, so it can only be run in that session."};
+    }
+
+    OutputSink sink(-1, FLUSH_FULL);
+    sink.setTarget(output);
+
+    EngineResult result{0, ""};
+    try {
+        runScript(program->node, &sink, RunOptions{options.optimise, options.unrollFactor, options.superinstructions,
+                                                  options.useJIT, options.jitThreshold, options.osrThreshold,
+                                                  limitsOf(options)});
+    }
+    catch (exception& e) {
+        result = EngineResult{1, e.what()};
+    }
+
+    sink.finish();
+    return result;
+}
+
+
+/*
+ * Runs a program with the globals of a session, passing its output to a callback.
+ * The globals the program declares are added to the session if it runs without an error, while any values
+ * it assigned to the session's globals before an error are kept.
+ */
+EngineResult Engine::run(const shared_ptr<EngineProgram>& program, EngineSession* session, const EngineOutput& output) {
+    if (program->session != 0 && program->session != session->id) {
+        return EngineResult{1, "The program was compiled in a different session."};
+    }
+    if (program->session != 0 && program->generation != session->generation) {
+        return EngineResult{1, "The session's globals have changed since the program was compiled, so it must be compiled again."};
+    }
+
+    OutputSink sink(-1, FLUSH_FULL);
+    sink.setTarget(output);
+    session->interpreter.setOutput(&sink);
+
+    SymbolTable* values = session->interpreter.getTable();
+    EngineResult result{0, ""};
+    unique_ptr<Governor> governor;
+    try {
+        //Each run gets the whole of each limit
+        if (limitsOf(options).isLimited()) {
+            governor.reset(new Governor(limitsOf(options)));
+            session->interpreter.setGovernor(governor.get());
+        }
+
+        program->node->accept(&session->interpreter);
+
+        //Add the types of the globals the program declared, which are fewer than it was checked with if it returned
+        //before reaching some of them. A program stays valid after its own declarations.
+        SymbolTable* types = session->semantic.getTable();
+        types->push();
+        for (auto& symbol : program->declarations) {
+            if (values->top()->count(symbol.first) > 0) {
+                types->top()->insert(symbol);
+            }
+        }
+
+        values->merge();
+        if (types->merge()) {
+            session->generation++;
+        }
+        if (program->session != 0) {
+            program->generation = session->generation;
+        }
+
+        //Other programs are freed once the caller is done with them, so a long session does not keep every statement.
+        //The JIT knows loops by their address, which a later program could reuse, so with it every program is kept
+        if (program->declaresFunctions || session->jit != nullptr) {
+            session->programs.insert(program);
+        }
+    }
+    catch (exception& e) {
+        values->unwind(1);
+        result = EngineResult{1, e.what()};
+    }
+
+    sink.finish();
+    session->interpreter.setOutput(&OutputSink::standardOutput());
+    session->interpreter.setGovernor(nullptr);
+    return result;
+}
@@ -0,0 +1,93 @@
+#ifndef CPS2000_ASSIGNMENT_ENGINE_H
+#define CPS2000_ASSIGNMENT_ENGINE_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+
+/*
+ * The public interface of libtealang, for running TeaLang programs inside another program.
+ * Only this header is needed to use the library, the compiler's own headers are not part of the interface.
+ */
+
+
+/*
+ * Receives the output of a program's print statements, in blocks which may hold several lines or part of one.
+ */
+typedef function<void(const char* data, size_t length)> EngineOutput;
+
+
+/*
+ * How programs are compiled and run, with the same defaults as the TeaLang executable.
+ */
+struct EngineOptions {
+    bool optimise;
+    int unrollFactor;
+    bool superinstructions;
+    bool useJIT;
+    int jitThreshold;
+    int osrThreshold;
+
+    //Limits on each run, 0 for no limit. A run which goes over one stops with an error, and a limited run
+    //is always interpreted
+    long long maxOperations;    //Loop iterations and function calls
+    long long maxMilliseconds;  //Wall clock time
+    int maxDepth;               //Function calls running at once
+    long long maxBytes;         //Memory taken by string values
+
+    EngineOptions();
+};
+
+
+/*
+ * Whether compiling or running a program succeeded, with the error if it did not.
+ * The status is the exit status the TeaLang executable would have had.
+ */
+struct EngineResult {
+    int status;
+    string error;
+
+    bool succeeded() const;
+};
+
+
+class EngineProgram;    //A compiled program, which can be run many times
+class EngineSession;    //Global variables and functions kept between the programs run in it
+
+
+/*
+ * Compiles TeaLang source into programs and runs them, reporting errors as results rather than exceptions.
+ *
+ * A program run on its own starts with no globals, exactly like a script run by the TeaLang executable.
+ * A program run in a session starts with the globals left by the programs run in it before, so later programs
+ * can use their variables and functions. A program which uses a session's globals must also be compiled in it,
+ * so they can be checked. A global declared again replaces the old one.
+ *
+ * Compiling is thread safe. A program or session may only be used by one thread at a time, so a program which
+ * runs on several threads at once must be compiled once for each thread.
+ */
+class Engine {
+public:
+    Engine();
+    explicit Engine(const EngineOptions& options);
+
+    shared_ptr<EngineSession> createSession();
+
+    EngineResult compile(const string& source, shared_ptr<EngineProgram>* program);
+    EngineResult compile(const string& source, EngineSession* session, shared_ptr<EngineProgram>* program);
+
+    EngineResult run(const shared_ptr<EngineProgram>& program, const EngineOutput& output);
+    EngineResult run(const shared_ptr<EngineProgram>& program, EngineSession* session, const EngineOutput& output);
+
+
+private:
+    EngineOptions options;
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_ENGINE_H
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+
+#include "Assembler.h"
+
+
+Assembler::Assembler() = default;
+
+
+/*
+ * Appends bytes to the code.
+ */
+void Assembler::emit(initializer_list<uint8_t> bytes) {
+    code.insert(code.end(), bytes);
+}
+
+
+/*
+ * Appends a little endian 32 bit value to the code.
+ */
+void Assembler::emit32(int32_t value) {
+    for (int i = 0; i < 4; i++) {
+        code.push_back((uint8_t) ((uint32_t) value >> (8 * i)));
+    }
+}
+
+
+/*
+ * Appends a little endian 64 bit value to the code.
+ */
+void Assembler::emit64(int64_t value) {
+    for (int i = 0; i < 8; i++) {
+        code.push_back((uint8_t) ((uint64_t) value >> (8 * i)));
+    }
+}
+
+
+/*
+ * The offset of the next byte to be emitted.
+ */
+size_t Assembler::position() {
+    return code.size();
+}
+
+
+/*
+ * Overwrites a 32 bit value which has already been emitted.
+ */
+void Assembler::patch32(size_t at, int32_t value) {
+    for (int i = 0; i < 4; i++) {
+        code[at + i] = (uint8_t) ((uint32_t) value >> (8 * i));
+    }
+}
+
+
+/*
+ * Emits a jump with a 32 bit displacement to a target which is not known yet.
+ * Returns the jump, which must later be passed to bind().
+ */
+size_t Assembler::jump(initializer_list<uint8_t> opcode) {
+    emit(opcode);
+    emit32(0);
+    return position() - 4;
+}
+
+
+/*
+ * Emits a jump with a 32 bit displacement to a position which has already been emitted.
+ */
+void Assembler::jumpTo(initializer_list<uint8_t> opcode, size_t target) {
+    emit(opcode);
+    emit32((int32_t) (target - (position() + 4)));
+}
+
+
+/*
+ * Makes a jump returned by jump() land on the next byte to be emitted.
+ */
+void Assembler::bind(size_t jump) {
+    patch32(jump, (int32_t) (position() - (jump + 4)));
+}
+
+
+/*
+ * Copies the code into newly mapped memory and makes it executable.
+ * The memory stays mapped until it is released, with the size of the code at the time it was finalised.
+ */
+void* Assembler::finalise() {
+
+    void* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw runtime_error("Executable memory could not be allocated.");
+    }
+
+    memcpy(memory, code.data(), code.size());
+
+    //The memory is never writable and executable at the same time
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, code.size());
+        throw runtime_error("Executable memory could not be protected.");
+    }
+
+    return memory;
+}
+
+
+/*
+ * Unmaps memory returned by finalise(), once none of its code can be called again.
+ */
+void Assembler::release(void* memory, size_t size) {
+    munmap(memory, size);
+}
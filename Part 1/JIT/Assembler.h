@@ -0,0 +1,41 @@
+#ifndef CPS2000_ASSIGNMENT_ASSEMBLER_H
+#define CPS2000_ASSIGNMENT_ASSEMBLER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * Collects machine code for a single function and copies it into executable memory.
+ * Forward jumps are emitted with a placeholder displacement which is patched once the target is known.
+ */
+class Assembler {
+public:
+    Assembler();
+
+    void emit(initializer_list<uint8_t> bytes);
+    void emit32(int32_t value);
+    void emit64(int64_t value);
+
+    size_t position();
+    void patch32(size_t at, int32_t value);
+
+    size_t jump(initializer_list<uint8_t> opcode);
+    void jumpTo(initializer_list<uint8_t> opcode, size_t target);
+    void bind(size_t jump);
+
+    void* finalise();
+    static void release(void* memory, size_t size);
+
+
+private:
+    vector<uint8_t> code;       //The machine code emitted so far
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_ASSEMBLER_H
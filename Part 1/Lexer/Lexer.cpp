@@ -14,14 +14,29 @@ stack<T> clearStack(stack<T> s);
 
 Lexer::Lexer() {
     initialiseReservedWords();
+    this->position = 0;
+    this->input = nullptr;
     this->lineNum = 1;
+    this->tokens = 0;
 }
 
 
 Lexer::Lexer(string* program) {
     initialiseReservedWords();
     this->program = *program;
+    this->position = 0;
+    this->input = nullptr;
     this->lineNum = 1;
+    this->tokens = 0;
+}
+
+
+Lexer::Lexer(istream* input) {
+    initialiseReservedWords();
+    this->position = 0;
+    this->input = input;
+    this->lineNum = 1;
+    this->tokens = 0;
 }
 
 
@@ -30,10 +45,34 @@ Lexer::Lexer(string* program) {
  */
 void Lexer::loadProgram(string* program) {
     this->program = *program;
+    this->position = 0;
+    this->input = nullptr;
     this->lineNum = 1;
 }
 
 
+/*
+ * True if the program has a character i places after the current position.
+ * Reading from a stream, more of the program is read if needed, and the characters already consumed are dropped.
+ */
+bool Lexer::isAvailable(size_t i) {
+    while (position + i >= program.size()) {
+        if (input == nullptr || !*input) {
+            return false;
+        }
+
+        program.erase(0, position);
+        position = 0;
+
+        char buffer[LEXER_READ_SIZE];
+        input->read(buffer, sizeof(buffer));
+        program.append(buffer, (size_t) input->gcount());
+    }
+
+    return true;
+}
+
+
 /*
  * Returns the next token in the program.
  */
@@ -46,7 +85,7 @@ Token Lexer::getNextToken() {
     do {
 
         //Check if we have reached the end of the program
-        if (program.empty()) {
+        if (!isAvailable(0)) {
             //We have reached the end of the program
             t.lineNum = lineNum;
             t.type = tEND;
@@ -60,15 +99,15 @@ Token Lexer::getNextToken() {
         string lexeme;
         stack <State> stack;
         stack.push(-1);     //Push "bad" state
-        int i = 0;
+        size_t i = 0;
 
 
 
         //Scanning Loop
-        while ((s != E) && (i < program.size())) {
+        while ((s != E) && isAvailable(i)) {
 
             //Read the next character
-            char c = program[i];
+            char c = program[position + i];
             lexeme += c;
 
             if (accepting[s] != tREJECTED) {
@@ -158,17 +197,26 @@ Token Lexer::getNextToken() {
         //Update the program number
         lineNum += countLines(lexeme);
 
-        //Remove the lexeme from the program
-        program = program.substr(lexeme.length());
+        //Move past the lexeme, rather than copying the rest of the program
+        position += lexeme.length();
 
 
     } while (!tokenFound);
 
 
+    tokens++;
     return t;
 }
 
 
+/*
+ * The number of tokens returned so far, not counting the end of the program.
+ */
+long long Lexer::getTokenCount() {
+    return tokens;
+}
+
+
 
 /*
  * Determines the category of a character read by the lexer.
@@ -8,25 +8,38 @@
 
 #include "../Token/Token.h"
 
+#define LEXER_READ_SIZE 65536   //Characters read from a stream at a time
+
 using namespace std;
 
 
 typedef int State;
 
 
+/*
+ * Splits a program into tokens, given either as a whole string or as a stream which is read as it is needed.
+ * Only the characters from the current token onwards are kept from a stream, so a program of any length
+ * can be read with memory bounded by its longest token.
+ */
 class Lexer {
 public:
     Lexer();
     explicit Lexer(string* program);
+    explicit Lexer(istream* input);
     void loadProgram(string* program);
     Token getNextToken();
+    long long getTokenCount();
 
 private:
     void initialiseReservedWords();
     TokenType checkReservedWord(const string& lexeme);
+    bool isAvailable(size_t i);
 
-    string program;
+    string program;     //The characters read and not yet consumed start at position
+    size_t position;
+    istream* input;     //Where more of the program is read from, null if the whole program is loaded
     int lineNum;
+    long long tokens;   //Number of tokens returned
 
     map<string, TokenType> reserved;
 };
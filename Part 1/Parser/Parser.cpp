@@ -10,6 +10,8 @@ bool isAddOp(const Token& t);
 
 Parser::Parser() {
     this->lexer = Lexer();
+    this->statistics = nullptr;
+    this->internStrings = true;
 }
 
 
@@ -17,6 +19,20 @@ Parser::Parser(string* program) {
     this->lexer = Lexer(program);
     this->next = lexer.getNextToken();
     this->nextnext = lexer.getNextToken();
+    this->statistics = nullptr;
+    this->internStrings = true;
+}
+
+
+/*
+ * Reads the program from a stream as it is parsed.
+ */
+Parser::Parser(istream* input) {
+    this->lexer = Lexer(input);
+    this->next = lexer.getNextToken();
+    this->nextnext = lexer.getNextToken();
+    this->statistics = nullptr;
+    this->internStrings = true;
 }
 
 
@@ -37,12 +53,45 @@ void Parser::loadProgram(string *program) {
  */
 Token Parser::getNextToken() {
     this->next = nextnext;
-    this->nextnext = lexer.getNextToken();
+
+    if (statistics == nullptr) {
+        this->nextnext = lexer.getNextToken();
+    }
+    else {
+        statistics->startLexing();
+        this->nextnext = lexer.getNextToken();
+        statistics->endLexing();
+    }
 
     return next;
 }
 
 
+/*
+ * Times the lexer separately from the parser.
+ */
+void Parser::setStatistics(Statistics* statistics) {
+    this->statistics = statistics;
+}
+
+
+/*
+ * String literals are interned by default, so each literal is stored once however many times it occurs.
+ * A program whose statements are freed as it runs can instead give each literal its own buffer, freed with it.
+ */
+void Parser::setInternStrings(bool enabled) {
+    this->internStrings = enabled;
+}
+
+
+/*
+ * The number of tokens read from the lexer so far.
+ */
+long long Parser::getTokenCount() {
+    return lexer.getTokenCount();
+}
+
+
 
 /*
  * Parse the program. Returns a constructed syntax tree.
@@ -61,6 +110,19 @@ ASTProgram* Parser::parseProgram() {
 }
 
 
+/*
+ * Parse the next top level statement, so a program can be run as it is read.
+ * Returns null once the end of the program is reached.
+ */
+ASTStatement* Parser::parseNextStatement() {
+    if (next.type == tEND) {
+        return nullptr;
+    }
+
+    return parseStatement();
+}
+
+
 /*
  * Parse Methods
  */
@@ -236,7 +298,12 @@ ASTLiteral * Parser::parseLiteral() {
             break;
 
         case tSTRINGLITERAL:
-            literal = new ASTLiteralString(tokenValue.substr(1, tokenValue.size()-2), lineNum);
+            if (internStrings) {
+                literal = new ASTLiteralString(TeaString::intern(tokenValue.substr(1, tokenValue.size()-2)), lineNum);
+            }
+            else {
+                literal = new ASTLiteralString(TeaString(tokenValue.substr(1, tokenValue.size()-2)), lineNum);
+            }
             break;
 
         default:
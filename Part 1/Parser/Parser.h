@@ -9,6 +9,7 @@
 #include "../Token/Token.h"
 
 #include "../AST/AST.h"
+#include "../Runtime/Statistics.h"
 
 using namespace std;
 
@@ -17,14 +18,22 @@ class Parser {
 public:
     Parser();
     explicit Parser(string* program);
+    explicit Parser(istream* input);
     void loadProgram(string* program);
 
     ASTProgram* parseProgram();
+    ASTStatement* parseNextStatement();
+
+    void setStatistics(Statistics* statistics);
+    void setInternStrings(bool enabled);
+    long long getTokenCount();
 
 private:
     Lexer lexer;
     Token next;     //Lookahead token
     Token nextnext; //Used when two lookahead tokens are required
+    Statistics* statistics; //Times the lexer, null if the lexer is not timed
+    bool internStrings;     //True if string literals share interned buffers which are never freed
 
     Token getNextToken();
 
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <unistd.h>
+#include "AsyncWriter.h"
+
+
+AsyncWriter::AsyncWriter(int fd) : queue(ASYNC_QUEUE_SIZE), head(0), tail(0), closing(false), waiting(false) {
+    this->fd = fd;
+    this->failed = false;
+    this->consumer = thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter() {
+    close();
+}
+
+
+/*
+ * Adds bytes to the end of the queue, waiting for the consumer to make room whenever it is full.
+ * Must only be called by one thread.
+ */
+void AsyncWriter::push(const char* data, size_t length) {
+
+    while (length > 0) {
+        size_t pushed = head.load(memory_order_relaxed);
+        size_t space = queue.size() - (pushed - tail.load(memory_order_acquire));
+
+        if (space == 0) {
+            wait([&]() { return tail.load(memory_order_acquire) != pushed - queue.size(); });
+            continue;
+        }
+
+        //Copy as much as fits before the end of the ring
+        size_t start = pushed % queue.size();
+        size_t count = min(min(length, space), queue.size() - start);
+        copy(data, data + count, queue.begin() + start);
+
+        head.store(pushed + count, memory_order_release);
+        notify();
+
+        data += count;
+        length -= count;
+    }
+}
+
+
+/*
+ * Waits for every byte pushed to be written, then stops the consumer thread.
+ */
+void AsyncWriter::close() {
+    if (!consumer.joinable()) {
+        return;
+    }
+
+    closing.store(true, memory_order_release);
+    notify();
+    consumer.join();
+}
+
+
+/*
+ * The consumer thread, which writes the bytes in the queue until it is closed and empty.
+ */
+void AsyncWriter::run() {
+
+    while (true) {
+        //Read closing first, so no bytes pushed before it was set can be missed
+        bool closed = closing.load(memory_order_acquire);
+        size_t written = tail.load(memory_order_relaxed);
+        size_t pushed = head.load(memory_order_acquire);
+
+        if (pushed == written) {
+            if (closed) {
+                return;
+            }
+
+            wait([&]() { return head.load(memory_order_acquire) != pushed || closing.load(memory_order_acquire); });
+            continue;
+        }
+
+        //Write the bytes up to the end of the ring
+        size_t start = written % queue.size();
+        size_t count = min(pushed - written, queue.size() - start);
+        writeAll(queue.data() + start, count);
+
+        tail.store(written + count, memory_order_release);
+        notify();
+    }
+}
+
+
+/*
+ * Sleeps until the other thread changes the queue so that the thread is ready to continue.
+ * The wait is bounded, so a notification sent just before waiting only causes a short delay.
+ */
+void AsyncWriter::wait(const function<bool()>& ready) {
+    unique_lock<mutex> guard(lock);
+    waiting.store(true, memory_order_seq_cst);
+
+    if (!ready()) {
+        changed.wait_for(guard, chrono::milliseconds(ASYNC_WAIT_MILLISECONDS));
+    }
+
+    waiting.store(false, memory_order_relaxed);
+}
+
+
+/*
+ * Wakes the other thread if it is waiting, only taking the lock when it is.
+ */
+void AsyncWriter::notify() {
+    if (waiting.load(memory_order_seq_cst)) {
+        lock_guard<mutex> guard(lock);
+        changed.notify_all();
+    }
+}
+
+
+/*
+ * Writes a block of bytes, retrying after interrupted and partial writes.
+ */
+void AsyncWriter::writeAll(const char* data, size_t length) {
+
+    while (length > 0 && !failed) {
+        ssize_t written = ::write(fd, data, length);
+
+        if (written < 0) {
+            //The reader may have gone away, keep emptying the queue so the producer is never blocked
+            failed = (errno != EINTR);
+            continue;
+        }
+
+        data += written;
+        length -= (size_t) written;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef CPS2000_ASSIGNMENT_ASYNCWRITER_H
+#define CPS2000_ASSIGNMENT_ASYNCWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define ASYNC_QUEUE_SIZE (1 << 20)      //Bytes which can be waiting to be written before the producer blocks
+#define ASYNC_WAIT_MILLISECONDS 1       //Longest a thread sleeps before checking the queue again
+
+using namespace std;
+
+
+/*
+ * Writes bytes to a file descriptor on a separate thread, so the thread producing them does not wait
+ * for a slow reader. Bytes are passed through a fixed size ring buffer with one producer and one consumer:
+ * each side only writes its own index, so neither takes a lock unless the queue is full or empty.
+ * Bytes are written in the order they were pushed, and everything pushed is written before close returns.
+ */
+class AsyncWriter {
+public:
+    explicit AsyncWriter(int fd);
+    ~AsyncWriter();
+
+    void push(const char* data, size_t length);
+    void close();
+
+
+private:
+    int fd;                     //Where the bytes are written
+    vector<char> queue;         //The ring buffer, indices are taken modulo its size
+    atomic<size_t> head;        //Total number of bytes pushed, only changed by the producer
+    atomic<size_t> tail;        //Total number of bytes written, only changed by the consumer
+    atomic<bool> closing;       //Set once nothing else will be pushed
+    bool failed;                //True once a write has failed, after which bytes are discarded
+
+    //Used to sleep while the queue is full or empty
+    mutex lock;
+    condition_variable changed;
+    atomic<bool> waiting;
+
+    thread consumer;
+
+    void run();
+    void wait(const function<bool()>& ready);
+    void notify();
+    void writeAll(const char* data, size_t length);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_ASYNCWRITER_H
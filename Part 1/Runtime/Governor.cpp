@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include "Governor.h"
+#include "TeaString.h"
+
+
+bool GovernorLimits::isLimited() const {
+    return operations > 0 || milliseconds > 0 || depth > 0 || bytes > 0;
+}
+
+
+Governor::Governor(const GovernorLimits& limits) {
+    this->limits = limits;
+    this->spent = 0;
+    this->granted = 0;
+    this->budget = 0;
+    this->depth = 0;
+    this->maxDepth = limits.depth > 0 ? limits.depth : INT_MAX;
+    this->deadline = chrono::steady_clock::now() + chrono::milliseconds(limits.milliseconds);
+
+    //Only memory taken after the script starts counts towards its limit
+    TeaString::setByteLimit(limits.bytes);
+
+    //Grant the first budget
+    check(0);
+}
+
+Governor::~Governor() {
+    TeaString::setByteLimit(0);
+}
+
+
+/*
+ * Counts the budget which was used, stops the script if it is over a limit, then grants a new budget.
+ * The budget is never larger than the operations left, so the operation limit is exact.
+ */
+void Governor::check(int lineNum) {
+    spent += granted - budget;
+
+    if (limits.operations > 0 && spent > limits.operations) {
+        exceeded(lineNum, "after running more than " + to_string(limits.operations) + " loop iterations and function calls");
+    }
+
+    if (limits.milliseconds > 0 && chrono::steady_clock::now() > deadline) {
+        exceeded(lineNum, "after running for more than " + to_string(limits.milliseconds) + " ms");
+    }
+
+    granted = GOVERNOR_CHECK_INTERVAL;
+    if (limits.operations > 0) {
+        granted = max(1LL, min(granted, limits.operations - spent));
+    }
+    budget = granted;
+}
+
+
+void Governor::exceeded(int lineNum, const string& reason) {
+    throw runtime_error("Line " + to_string(lineNum) + ": Stopped " + reason + ".");
+}
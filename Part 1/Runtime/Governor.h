@@ -0,0 +1,78 @@
+#ifndef CPS2000_ASSIGNMENT_GOVERNOR_H
+#define CPS2000_ASSIGNMENT_GOVERNOR_H
+
+#include <chrono>
+#include <string>
+
+#define GOVERNOR_CHECK_INTERVAL 1024    //Loop iterations and function calls counted between checks of the limits
+
+using namespace std;
+
+
+/*
+ * The most a script may use while it runs, 0 for no limit.
+ */
+struct GovernorLimits {
+    long long operations;       //Loop iterations and function calls
+    long long milliseconds;     //Wall clock time
+    int depth;                  //Function calls running at once
+    long long bytes;            //Memory taken by string values
+
+    bool isLimited() const;
+};
+
+
+/*
+ * Stops a script which goes over its limits, with a runtime_error saying which limit it reached.
+ *
+ * The interpreter counts each loop iteration and function call, which are the only ways a script can keep
+ * running, by decrementing a budget. The limits are only checked when the budget runs out, every
+ * GOVERNOR_CHECK_INTERVAL operations, so the clock is read rarely and the common case is a decrement and
+ * a branch. The call depth is checked on every call, as it is only an increment and a compare.
+ * The memory limit is checked by TeaString whenever a value allocates a buffer, as a single operation
+ * such as s = s + s can double the memory a script takes.
+ *
+ * Code compiled by the JIT does not count its operations, so a governed script must be interpreted.
+ */
+class Governor {
+public:
+    explicit Governor(const GovernorLimits& limits);
+    ~Governor();
+
+    //Counts operations, checking the limits once the budget runs out
+    void tick(int lineNum, long long operations = 1) {
+        budget -= operations;
+        if (budget <= 0) {
+            check(lineNum);
+        }
+    }
+
+    //Counts a function call, checking how deeply calls are nested
+    void enter(int lineNum) {
+        if (++depth > maxDepth) {
+            exceeded(lineNum, "as function calls were nested more than " + to_string(limits.depth) + " deep");
+        }
+        tick(lineNum);
+    }
+
+    void leave() {
+        depth--;
+    }
+
+
+private:
+    GovernorLimits limits;
+    long long budget;           //Operations left before the limits are checked again
+    long long granted;          //The size of the current budget
+    long long spent;            //Operations counted before the current budget
+    int depth;                  //Function calls running
+    int maxDepth;
+    chrono::steady_clock::time_point deadline;
+
+    void check(int lineNum);
+    [[noreturn]] static void exceeded(int lineNum, const string& reason);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_GOVERNOR_H
@@ -0,0 +1,223 @@
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <unistd.h>
+#include "OutputSink.h"
+
+
+OutputSink::OutputSink(int fd, FlushPolicy policy) {
+    this->fd = fd;
+    this->policy = policy;
+    this->failed = false;
+    this->bytesWritten = 0;
+    this->buffer.reserve(OUTPUT_BUFFER_SIZE);
+}
+
+OutputSink::~OutputSink() {
+    finish();
+}
+
+
+/*
+ * The sink for the process's standard output, which is flushed when the process exits normally.
+ */
+OutputSink& OutputSink::standardOutput() {
+    static OutputSink output(STDOUT_FILENO, defaultPolicy(STDOUT_FILENO));
+    return output;
+}
+
+
+/*
+ * Output shown in a terminal is flushed after every line, anything else is fully buffered.
+ */
+FlushPolicy OutputSink::defaultPolicy(int fd) {
+    return isatty(fd) ? FLUSH_LINE : FLUSH_FULL;
+}
+
+
+/*
+ * Reads the name of a flush policy given on the command line, line, full or never-until-exit.
+ * Returns false if the name is not recognised.
+ */
+bool OutputSink::parsePolicy(const string& name, FlushPolicy* policy) {
+    if (name == "line") {
+        *policy = FLUSH_LINE;
+    }
+    else if (name == "full") {
+        *policy = FLUSH_FULL;
+    }
+    else if (name == "never-until-exit") {
+        *policy = FLUSH_AT_EXIT;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+
+void OutputSink::setPolicy(FlushPolicy policy) {
+    this->policy = policy;
+}
+
+
+/*
+ * Starts or stops writing output on a separate thread.
+ */
+void OutputSink::setAsync(bool enabled) {
+    flush();
+
+    if (enabled && writer == nullptr) {
+        writer.reset(new AsyncWriter(fd));
+    }
+    else if (!enabled) {
+        writer.reset();
+    }
+}
+
+
+/*
+ * Passes each block of output to a function instead of writing it to the file descriptor,
+ * so the caller can wrap it before sending it on.
+ */
+void OutputSink::setTarget(const function<void(const char*, size_t)>& target) {
+    flush();
+    this->target = target;
+}
+
+
+void OutputSink::write(const char* data, size_t length) {
+
+    //Make room in the buffer, unless it should hold everything until exit
+    if (policy != FLUSH_AT_EXIT && buffer.size() + length > OUTPUT_BUFFER_SIZE) {
+        flush();
+
+        //Blocks larger than the buffer are written directly
+        if (length > OUTPUT_BUFFER_SIZE) {
+            writeAll(data, length);
+            return;
+        }
+    }
+
+    buffer.insert(buffer.end(), data, data + length);
+}
+
+
+void OutputSink::write(const TeaString& s) {
+    write(s.data(), s.length());
+}
+
+
+/*
+ * Values are formatted in the same way as printing them to an ostream,
+ * but directly into the buffer and independently of the locale.
+ */
+void OutputSink::write(bool b) {
+    if (b) {
+        write("true", 4);
+    }
+    else {
+        write("false", 5);
+    }
+}
+
+void OutputSink::write(float f) {
+    //Equivalent to printf("%g"), which is what an ostream uses by default
+    char* first = reserve(MAX_NUMBER_LENGTH);
+    to_chars_result result = to_chars(first, first + MAX_NUMBER_LENGTH, f, chars_format::general, 6);
+    buffer.resize(result.ptr - buffer.data());
+}
+
+void OutputSink::write(int i) {
+    char* first = reserve(MAX_NUMBER_LENGTH);
+    to_chars_result result = to_chars(first, first + MAX_NUMBER_LENGTH, i);
+    buffer.resize(result.ptr - buffer.data());
+}
+
+
+/*
+ * Ends the line being printed.
+ */
+void OutputSink::endLine() {
+    write("\n", 1);
+
+    if (policy == FLUSH_LINE) {
+        flush();
+    }
+}
+
+
+/*
+ * Adds space for up to length bytes to the end of the buffer, flushing it first if it is full.
+ * Returns where the bytes should be written, the buffer must then be resized to the bytes actually used.
+ */
+char* OutputSink::reserve(size_t length) {
+    if (policy != FLUSH_AT_EXIT && buffer.size() + length > OUTPUT_BUFFER_SIZE) {
+        flush();
+    }
+
+    size_t used = buffer.size();
+    buffer.resize(used + length);
+    return buffer.data() + used;
+}
+
+
+/*
+ * Writes everything in the buffer, or passes it to the writer thread.
+ */
+void OutputSink::flush() {
+    if (!buffer.empty()) {
+        writeAll(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+
+/*
+ * Writes everything in the buffer and waits until the writer thread, if any, has written it too.
+ * Output printed afterwards is written synchronously.
+ */
+void OutputSink::finish() {
+    flush();
+    writer.reset();
+}
+
+
+/*
+ * The number of bytes of output written so far, not counting any still in the buffer.
+ */
+long long OutputSink::getBytesWritten() {
+    return bytesWritten;
+}
+
+
+/*
+ * Writes a block of output, retrying after interrupted and partial writes.
+ */
+void OutputSink::writeAll(const char* data, size_t length) {
+    bytesWritten += (long long) length;
+
+    if (target) {
+        target(data, length);
+        return;
+    }
+
+    if (writer != nullptr) {
+        writer->push(data, length);
+        return;
+    }
+
+    while (length > 0 && !failed) {
+        ssize_t written = ::write(fd, data, length);
+
+        if (written < 0) {
+            //The reader may have gone away, the rest of the output cannot be written anywhere
+            failed = (errno != EINTR);
+            continue;
+        }
+
+        data += written;
+        length -= (size_t) written;
+    }
+}
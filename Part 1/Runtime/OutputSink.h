@@ -0,0 +1,76 @@
+#ifndef CPS2000_ASSIGNMENT_OUTPUTSINK_H
+#define CPS2000_ASSIGNMENT_OUTPUTSINK_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AsyncWriter.h"
+#include "TeaString.h"
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)    //Bytes buffered before they are written, unless flushing only at exit
+#define MAX_NUMBER_LENGTH 32            //Longest text of a formatted int or float
+
+using namespace std;
+
+
+/*
+ * When the output of print statements is written to the file descriptor.
+ */
+enum FlushPolicy {
+    FLUSH_LINE,         //After every line, so output appears as soon as it is printed
+    FLUSH_FULL,         //Whenever the buffer is full
+    FLUSH_AT_EXIT       //Only when flushed explicitly, the buffer grows to hold all the output
+};
+
+
+/*
+ * Collects the output of print statements in a buffer and writes it to a file descriptor in large blocks,
+ * rather than making a system call for every line.
+ * In asynchronous mode the blocks are passed to an AsyncWriter instead, so a slow reader only blocks
+ * the program once the writer's queue is full.
+ * The program's output must be finished before exiting, including when it stops with an error.
+ */
+class OutputSink {
+public:
+    OutputSink(int fd, FlushPolicy policy);
+    ~OutputSink();
+
+    static OutputSink& standardOutput();
+    static FlushPolicy defaultPolicy(int fd);
+    static bool parsePolicy(const string& name, FlushPolicy* policy);
+
+    void setPolicy(FlushPolicy policy);
+    void setAsync(bool enabled);
+    void setTarget(const function<void(const char*, size_t)>& target);
+
+    void write(const char* data, size_t length);
+    void write(const TeaString& s);
+    void write(bool b);
+    void write(float f);
+    void write(int i);
+    void endLine();
+
+    void flush();
+    void finish();
+
+    long long getBytesWritten();
+
+
+private:
+    int fd;                     //Where the output is written
+    FlushPolicy policy;
+    vector<char> buffer;        //Output which has not been written yet
+    bool failed;                //True once a write has failed, after which output is discarded
+    long long bytesWritten;     //Bytes flushed from the buffer, or passed straight through it
+    function<void(const char*, size_t)> target;     //Receives each block instead of the file descriptor, if set
+    unique_ptr<AsyncWriter> writer; //Writes flushed output on another thread, null when writing synchronously
+
+    char* reserve(size_t length);
+    void writeAll(const char* data, size_t length);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_OUTPUTSINK_H
@@ -0,0 +1,183 @@
+#include <iomanip>
+#include "Statistics.h"
+
+
+StatisticsClock StatisticsClock::now() {
+    return StatisticsClock{chrono::steady_clock::now(), clock()};
+}
+
+
+//Milliseconds between two points in time
+static double wallMilliseconds(const StatisticsClock& start, const StatisticsClock& end) {
+    return chrono::duration<double, milli>(end.wall - start.wall).count();
+}
+
+static double cpuMilliseconds(const StatisticsClock& start, const StatisticsClock& end) {
+    return 1000.0 * (double) (end.cpu - start.cpu) / CLOCKS_PER_SEC;
+}
+
+
+Statistics::Statistics() {
+    this->phaseStart = StatisticsClock::now();
+    this->lexStart = phaseStart;
+    this->lexWall = 0;
+    this->lexCPU = 0;
+
+    //Every counter is reported, even if the stage which keeps it did not run
+    for (const char* name : {"tokens", "scopes_pushed", "symbol_lookups", "function_calls", "bytes_printed"}) {
+        counters.emplace_back(name, 0);
+    }
+
+    //Likewise every phase of the driver, even if the stage did not run or the program came from the cache
+    for (const char* name : {"read", "load", "tokens", "cache", "lex", "parse", "xml", "semantic", "emit-ast",
+                             "emit-c", "aot", "optimise", "execute", "error"}) {
+        totals.push_back(PhaseTime{name, 0, 0});
+    }
+}
+
+
+/*
+ * Records how long a phase took, and starts timing the next phase.
+ * Any lexing done during the phase is recorded as a separate phase before it.
+ */
+void Statistics::endPhase(const string& phase) {
+    StatisticsClock now = StatisticsClock::now();
+    double wall = wallMilliseconds(phaseStart, now);
+    double cpu = cpuMilliseconds(phaseStart, now);
+
+    if (lexWall > 0 || lexCPU > 0) {
+        record("lex", lexWall, lexCPU);
+        wall -= lexWall;
+        cpu -= lexCPU;
+        lexWall = 0;
+        lexCPU = 0;
+    }
+
+    record(phase, wall, cpu);
+    phaseStart = now;
+}
+
+
+/*
+ * Starts timing the next phase without recording the time since the last, for work done only for the report.
+ */
+void Statistics::skipPhase() {
+    phaseStart = StatisticsClock::now();
+}
+
+
+/*
+ * Adds a phase to the list in the order they ran, and to its total.
+ */
+void Statistics::record(const string& phase, double wall, double cpu) {
+    phases.push_back(PhaseTime{phase, wall, cpu});
+
+    for (PhaseTime& total : totals) {
+        if (total.phase == phase) {
+            total.wall += wall;
+            total.cpu += cpu;
+            return;
+        }
+    }
+
+    totals.push_back(PhaseTime{phase, wall, cpu});
+}
+
+
+/*
+ * Times the lexer while it finds a token, so the time can be taken out of the phase which asked for it.
+ */
+void Statistics::startLexing() {
+    lexStart = StatisticsClock::now();
+}
+
+void Statistics::endLexing() {
+    StatisticsClock now = StatisticsClock::now();
+    lexWall += wallMilliseconds(lexStart, now);
+    lexCPU += cpuMilliseconds(lexStart, now);
+}
+
+
+void Statistics::setCounter(const string& name, long long value) {
+    set(counters, name, value);
+}
+
+void Statistics::setNodeCount(const string& kind, long long count) {
+    set(nodes, kind, count);
+}
+
+
+/*
+ * Sets a value, adding it after the others if it is new so the order values are reported in never changes.
+ */
+void Statistics::set(vector<pair<string, long long>>& values, const string& name, long long value) {
+    for (pair<string, long long>& existing : values) {
+        if (existing.first == name) {
+            existing.second = value;
+            return;
+        }
+    }
+
+    values.emplace_back(name, value);
+}
+
+
+/*
+ * Prints the time taken by each phase, for reading in a terminal.
+ */
+void Statistics::printTable(ostream& out) {
+    double wall = 0;
+    double cpu = 0;
+
+    out << "Phase            wall ms       cpu ms" << endl;
+    out << fixed << setprecision(3);
+
+    for (const PhaseTime& phase : phases) {
+        out << left << setw(10) << phase.phase << right << setw(14) << phase.wall << setw(13) << phase.cpu << endl;
+        wall += phase.wall;
+        cpu += phase.cpu;
+    }
+
+    out << left << setw(10) << "total" << right << setw(14) << wall << setw(13) << cpu << endl;
+}
+
+
+/*
+ * Prints the phases and counters as a JSON object.
+ */
+void Statistics::printJSON(ostream& out) {
+    double wall = 0;
+    double cpu = 0;
+
+    out << fixed << setprecision(3);
+    out << "{" << endl;
+    out << "  \"version\": " << STATISTICS_VERSION << "," << endl;
+
+    //Every phase is listed in the same order, with the total of each time it ran
+    out << "  \"phases\": [";
+    for (size_t i = 0; i < totals.size(); i++) {
+        out << (i == 0 ? "" : ",") << endl;
+        out << "    {\"name\": \"" << totals[i].phase << "\", \"wall_ms\": " << totals[i].wall
+            << ", \"cpu_ms\": " << totals[i].cpu << "}";
+        wall += totals[i].wall;
+        cpu += totals[i].cpu;
+    }
+    out << endl << "  ]," << endl;
+
+    out << "  \"total\": {\"wall_ms\": " << wall << ", \"cpu_ms\": " << cpu << "}," << endl;
+
+    out << "  \"counters\": {";
+    for (size_t i = 0; i < counters.size(); i++) {
+        out << (i == 0 ? "" : ",") << endl;
+        out << "    \"" << counters[i].first << "\": " << counters[i].second;
+    }
+    out << endl << "  }," << endl;
+
+    out << "  \"nodes\": {";
+    for (size_t i = 0; i < nodes.size(); i++) {
+        out << (i == 0 ? "" : ",") << endl;
+        out << "    \"" << nodes[i].first << "\": " << nodes[i].second;
+    }
+    out << endl << "  }" << endl;
+    out << "}" << endl;
+}
@@ -0,0 +1,83 @@
+#ifndef CPS2000_ASSIGNMENT_STATISTICS_H
+#define CPS2000_ASSIGNMENT_STATISTICS_H
+
+#include <chrono>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define STATISTICS_VERSION 2    //Increase whenever a field of the JSON report is renamed, removed or changes meaning
+
+using namespace std;
+
+
+/*
+ * A point in time on both the wall clock and the CPU clock of the process.
+ */
+struct StatisticsClock {
+    chrono::steady_clock::time_point wall;
+    clock_t cpu;
+
+    static StatisticsClock now();
+};
+
+
+/*
+ * How long a phase of the driver took, in milliseconds.
+ */
+struct PhaseTime {
+    string phase;
+    double wall;
+    double cpu;
+};
+
+
+/*
+ * Times each phase of a run and collects counters from the stages, then reports them as a table or as JSON.
+ *
+ * Phases are timed back to back, each ending where the next starts. The parser pulls tokens from the lexer as
+ * it goes, so lexing is timed separately while parsing and reported as its own phase before the parse.
+ * The counters are kept by the stages themselves and only copied here once the run is over, so collecting
+ * them costs nothing beyond the increments the stages always make.
+ *
+ * The JSON report always has the same fields in the same order, with zero for anything that did not run,
+ * so it can be compared between runs. Its phases are totalled by name in a fixed order, while the table lists
+ * them in the order they ran. Work done only to report statistics is skipped rather than timed as a phase,
+ * so it is never part of the totals. STATISTICS_VERSION is increased whenever a field changes.
+ */
+class Statistics {
+public:
+    Statistics();
+
+    void endPhase(const string& phase);
+    void skipPhase();
+    void startLexing();
+    void endLexing();
+
+    void setCounter(const string& name, long long value);
+    void setNodeCount(const string& kind, long long count);
+
+    void printTable(ostream& out);
+    void printJSON(ostream& out);
+
+
+private:
+    StatisticsClock phaseStart;
+    StatisticsClock lexStart;
+    double lexWall;             //Time spent lexing during the current phase
+    double lexCPU;
+
+    vector<PhaseTime> phases;   //Every phase in the order it ran
+    vector<PhaseTime> totals;   //The time of each phase by name, in a fixed order
+    vector<pair<string, long long>> counters;
+    vector<pair<string, long long>> nodes;
+
+    void record(const string& phase, double wall, double cpu);
+    static void set(vector<pair<string, long long>>& values, const string& name, long long value);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_STATISTICS_H
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+#include "TeaString.h"
+
+
+thread_local long long TeaString::liveBytes = 0;
+thread_local long long TeaString::byteLimit = 0;
+thread_local long long TeaString::byteBase = 0;
+
+
+char* StringBuffer::characters() {
+    return reinterpret_cast<char*>(this + 1);
+}
+
+
+TeaString::TeaString() {
+    this->size = 0;
+}
+
+TeaString::TeaString(const string& s) : TeaString(s.data(), s.size()) {
+}
+
+TeaString::TeaString(const char* s) : TeaString(s, strlen(s)) {
+}
+
+TeaString::TeaString(const char* s, size_t length) {
+    this->size = length;
+
+    if (isSmall()) {
+        memcpy(small, s, length);
+    }
+    else {
+        buffer = allocateValue(length);
+        memcpy(buffer->characters(), s, length);
+        buffer->used = length;
+    }
+}
+
+
+TeaString::TeaString(const TeaString& other) {
+    memcpy(small, other.small, sizeof(small));
+    this->size = other.size;
+    retain();
+}
+
+TeaString::TeaString(TeaString&& other) noexcept {
+    memcpy(small, other.small, sizeof(small));
+    this->size = other.size;
+    other.size = 0;
+}
+
+TeaString& TeaString::operator=(const TeaString& other) {
+    //Retain first, in case both values share the buffer
+    TeaString copy(other);
+    release();
+
+    memcpy(small, copy.small, sizeof(small));
+    size = copy.size;
+    copy.size = 0;
+    return *this;
+}
+
+TeaString& TeaString::operator=(TeaString&& other) noexcept {
+    if (this != &other) {
+        release();
+
+        memcpy(small, other.small, sizeof(small));
+        size = other.size;
+        other.size = 0;
+    }
+    return *this;
+}
+
+TeaString::~TeaString() {
+    release();
+}
+
+
+/*
+ * Returns the value of a string literal, sharing one buffer between every literal with the same characters.
+ * Interned buffers are never freed, so values using them skip reference counting altogether.
+ */
+TeaString TeaString::intern(const string& s) {
+    if (s.size() <= SMALL_STRING_CAPACITY) {
+        return TeaString(s);
+    }
+
+    static mutex lock;
+    static unordered_map<string, StringBuffer*> interned;
+    lock_guard<mutex> guard(lock);
+
+    StringBuffer*& shared = interned[s];
+    if (shared == nullptr) {
+        shared = allocate(s.size());
+        memcpy(shared->characters(), s.data(), s.size());
+        shared->used = s.size();
+        shared->references = INTERNED_REFERENCES;
+    }
+
+    TeaString value;
+    value.buffer = shared;
+    value.size = s.size();
+    return value;
+}
+
+
+size_t TeaString::length() const {
+    return size;
+}
+
+
+/*
+ * The characters of the string, which are not null terminated.
+ * Only valid until the value is changed or destroyed.
+ */
+const char* TeaString::data() const {
+    return isSmall() ? small : buffer->characters();
+}
+
+
+/*
+ * Copies the string into a std::string.
+ */
+string TeaString::str() const {
+    return string(data(), size);
+}
+
+
+/*
+ * Appends another string to this one.
+ * The buffer is only copied if it is full, or another value has already appended to it.
+ */
+void TeaString::append(const TeaString& other) {
+
+    if (other.size == 0) {
+        return;
+    }
+
+    size_t total = size + other.size;
+
+    //Short results stay inline
+    if (total <= SMALL_STRING_CAPACITY) {
+        memcpy(small + size, other.data(), other.size);
+        size = total;
+        return;
+    }
+
+    //Write after the end of the buffer, which no other value is using
+    //The other string may share the buffer, but only uses a prefix of what is already written
+    if (!isSmall() && buffer->used == size && buffer->capacity >= total) {
+        memcpy(buffer->characters() + size, other.data(), other.size);
+        buffer->used = total;
+        size = total;
+        return;
+    }
+
+    //Leave room to append to the new buffer in place
+    StringBuffer* grown = allocateValue(2 * total);
+    memcpy(grown->characters(), data(), size);
+    memcpy(grown->characters() + size, other.data(), other.size);
+    grown->used = total;
+
+    release();
+    buffer = grown;
+    size = total;
+}
+
+
+/*
+ * Compares two strings in the same way as std::string::compare.
+ */
+int TeaString::compare(const TeaString& other) const {
+
+    int result = memcmp(data(), other.data(), min(size, other.size));
+    if (result != 0) {
+        return result;
+    }
+
+    if (size < other.size) {
+        return -1;
+    }
+    return (size > other.size) ? 1 : 0;
+}
+
+
+bool TeaString::isSmall() const {
+    return size <= SMALL_STRING_CAPACITY;
+}
+
+
+void TeaString::retain() {
+    if (!isSmall() && buffer->references != INTERNED_REFERENCES) {
+        buffer->references++;
+    }
+}
+
+
+void TeaString::release() {
+    if (!isSmall() && buffer->references != INTERNED_REFERENCES && --buffer->references == 0) {
+        liveBytes -= (long long) (sizeof(StringBuffer) + buffer->capacity);
+        free(buffer);
+    }
+}
+
+
+/*
+ * Allocates a buffer used by one value, with the header and characters in a single block.
+ */
+StringBuffer* TeaString::allocate(size_t capacity) {
+    auto allocated = static_cast<StringBuffer*>(malloc(sizeof(StringBuffer) + capacity));
+    if (allocated == nullptr) {
+        throw bad_alloc();
+    }
+
+    allocated->references = 1;
+    allocated->capacity = capacity;
+    allocated->used = 0;
+    return allocated;
+}
+
+
+/*
+ * Allocates a buffer for a value, counting it towards the memory used by the script running on this thread.
+ */
+StringBuffer* TeaString::allocateValue(size_t capacity) {
+    long long bytes = (long long) (sizeof(StringBuffer) + capacity);
+
+    if (byteLimit > 0 && liveBytes - byteBase + bytes > byteLimit) {
+        throw ByteLimitError("Stopped as string values would take more than " + to_string(byteLimit) + " bytes.");
+    }
+
+    liveBytes += bytes;
+    return allocate(capacity);
+}
+
+
+/*
+ * The bytes taken by the buffers of values allocated on this thread.
+ */
+long long TeaString::getLiveBytes() {
+    return liveBytes;
+}
+
+
+/*
+ * Limits the bytes values allocated on this thread may take from now on, 0 for no limit.
+ * Values which are already live do not count towards the limit.
+ */
+void TeaString::setByteLimit(long long limit) {
+    byteLimit = limit;
+    byteBase = liveBytes;
+}
+
+
+ostream& operator<<(ostream& out, const TeaString& s) {
+    return out.write(s.data(), s.length());
+}
@@ -0,0 +1,103 @@
+#ifndef CPS2000_ASSIGNMENT_TEASTRING_H
+#define CPS2000_ASSIGNMENT_TEASTRING_H
+
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#define SMALL_STRING_CAPACITY 16    //Strings up to this length are stored inside the value itself
+#define INTERNED_REFERENCES (-1)    //Reference count of buffers owned by the intern table, which are never freed
+
+using namespace std;
+
+
+/*
+ * The characters of a string too long to store inline, followed directly by the header in memory.
+ * Only the first used characters have been written.
+ */
+struct StringBuffer {
+    long references;            //Number of values using the buffer, or INTERNED_REFERENCES
+    size_t capacity;            //Number of characters which fit in the buffer
+    size_t used;                //Number of characters written so far
+
+    char* characters();
+};
+
+
+/*
+ * Thrown when a value would take the values allocated on a thread past their limit.
+ * The message has no line number, as the string does not know which statement is running.
+ */
+class ByteLimitError : public runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+
+/*
+ * The value of a TeaLang string at runtime.
+ *
+ * Strings of up to SMALL_STRING_CAPACITY characters are stored inline, so copying one never allocates.
+ * Longer strings share a reference counted buffer, each copy using a prefix of it, so copying one is a
+ * pointer copy and an increment. Characters in the buffer are never changed once written, so a string
+ * which ends where its buffer ends can be appended to in place without affecting any other value
+ * sharing the buffer. Building a string one piece at a time, s = s + piece, therefore takes amortised
+ * O(piece) time rather than copying the whole string.
+ *
+ * String literals are interned by the parser, so every occurrence of the same literal shares one
+ * buffer which lives until the program exits and is never reference counted.
+ *
+ * The buffers of values are counted on the thread which allocates them, so the memory a script uses can be
+ * limited. Strings are the only values which grow while a script runs. Interned literals are not counted.
+ */
+class TeaString {
+public:
+    TeaString();
+    TeaString(const string& s);
+    TeaString(const char* s);
+    TeaString(const char* s, size_t length);
+
+    TeaString(const TeaString& other);
+    TeaString(TeaString&& other) noexcept;
+    TeaString& operator=(const TeaString& other);
+    TeaString& operator=(TeaString&& other) noexcept;
+    ~TeaString();
+
+    static TeaString intern(const string& s);
+    static long long getLiveBytes();
+    static void setByteLimit(long long limit);
+
+    size_t length() const;
+    const char* data() const;
+    string str() const;
+
+    void append(const TeaString& other);
+    int compare(const TeaString& other) const;
+
+
+private:
+    union {
+        char small[SMALL_STRING_CAPACITY];  //The characters of a short string
+        StringBuffer* buffer;               //The buffer holding a long string
+    };
+    size_t size;                            //Number of characters in the value, which is stored inline if small
+
+    bool isSmall() const;
+    void retain();
+    void release();
+
+    static thread_local long long liveBytes;    //Bytes of value buffers allocated on this thread and not yet freed
+    static thread_local long long byteLimit;    //Bytes the values allocated since the limit was set may take, 0 for no limit
+    static thread_local long long byteBase;     //Live bytes when the limit was set
+
+    static StringBuffer* allocate(size_t capacity);
+    static StringBuffer* allocateValue(size_t capacity);
+};
+
+
+ostream& operator<<(ostream& out, const TeaString& s);
+
+
+
+#endif //CPS2000_ASSIGNMENT_TEASTRING_H
@@ -0,0 +1,82 @@
+#include <thread>
+#include "WorkStealingPool.h"
+
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    this->threads = threads;
+
+    for (int i = 0; i < threads; i++) {
+        queues.emplace_back(new Queue());
+    }
+}
+
+
+/*
+ * Runs task(0) to task(tasks - 1), returning once all of them have finished.
+ * The tasks must not throw.
+ */
+void WorkStealingPool::run(size_t tasks, const function<void(size_t)>& task) {
+
+    //Deal the tasks out in turn, so each thread starts with tasks from across the list
+    for (size_t i = 0; i < tasks; i++) {
+        queues[i % threads]->tasks.push_front(i);
+    }
+
+    //This thread is the first worker
+    vector<thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(&WorkStealingPool::work, this, i, cref(task));
+    }
+    work(0, task);
+
+    for (thread& t : pool) {
+        t.join();
+    }
+}
+
+
+/*
+ * Runs tasks until there are none left in any queue.
+ * No tasks are added once the threads start, so a thread which finds every queue empty can stop.
+ */
+void WorkStealingPool::work(int worker, const function<void(size_t)>& task) {
+    size_t next;
+
+    while (take(worker, &next)) {
+        task(next);
+    }
+}
+
+
+/*
+ * Takes the next task from the thread's own queue, or steals one from another thread.
+ * Returns false if every queue is empty.
+ */
+bool WorkStealingPool::take(int worker, size_t* task) {
+
+    //The earliest task dealt to this thread, so each thread runs its own tasks in the order they were listed
+    {
+        Queue* own = queues[worker].get();
+        lock_guard<mutex> guard(own->lock);
+
+        if (!own->tasks.empty()) {
+            *task = own->tasks.back();
+            own->tasks.pop_back();
+            return true;
+        }
+    }
+
+    //The latest task dealt to the next thread with any left, which that thread would have run last
+    for (int i = 1; i < threads; i++) {
+        Queue* victim = queues[(worker + i) % threads].get();
+        lock_guard<mutex> guard(victim->lock);
+
+        if (!victim->tasks.empty()) {
+            *task = victim->tasks.front();
+            victim->tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,44 @@
+#ifndef CPS2000_ASSIGNMENT_WORKSTEALINGPOOL_H
+#define CPS2000_ASSIGNMENT_WORKSTEALINGPOOL_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * Runs a fixed set of tasks on several threads.
+ * Each thread has its own queue of tasks, which are dealt out in turn before any thread starts. A thread takes
+ * tasks from the back of its own queue, and once that is empty it steals from the front of the other threads'
+ * queues, so a thread given a few slow tasks does not leave the others idle.
+ * Each queue has its own lock, which is only contended while a task is being stolen from it.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads);
+
+    void run(size_t tasks, const function<void(size_t)>& task);
+
+
+private:
+    //The tasks waiting to be run by a thread
+    struct Queue {
+        mutex lock;
+        deque<size_t> tasks;
+    };
+
+    int threads;
+    vector<unique_ptr<Queue>> queues;
+
+    void work(int worker, const function<void(size_t)>& task);
+    bool take(int worker, size_t* task);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_WORKSTEALINGPOOL_H
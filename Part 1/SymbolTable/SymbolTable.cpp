@@ -1,6 +1,10 @@
 #include "SymbolTable.h"
 
-SymbolTable::SymbolTable() = default;
+SymbolTable::SymbolTable() {
+    this->pushes = 0;
+    this->lookups = 0;
+    this->lookupLog = nullptr;
+}
 
 
 /*
@@ -12,17 +16,80 @@ SymbolTable::SymbolTable() = default;
  * Create a new scope on the stack.
  */
 void SymbolTable::push() {
+    pushes++;
     Scope s;
     stack.push_back(s);
 }
 
 /*
- * Remove the innermost scope from the stack.
+ * Remove the innermost scope from the stack, freeing the values of its variables.
  */
 void SymbolTable::pop() {
+    for (auto& symbol : *top()) {
+        delete symbol.second.value;
+    }
+
     stack.pop_back();
 }
 
+/*
+ * Moves the symbols of the innermost scope into the scope below it, then removes the innermost scope.
+ * A symbol replaces any symbol with the same identifier below it, including every overload of a function.
+ * Returns true if the identifiers or types of the symbols in the scope below changed.
+ */
+bool SymbolTable::merge() {
+    Scope* inner = top();
+    Scope* outer = &*(stack.end()-2);
+    bool changed = false;
+
+    for (auto& symbol : *inner) {
+        auto existing = outer->find(symbol.first);
+
+        if (existing == outer->end()) {
+            outer->insert(symbol);
+            changed = true;
+        }
+        else {
+            Symbol* s = &existing->second;
+            if (s->type != symbol.second.type || s->func.size() != symbol.second.func.size()) {
+                changed = true;
+            }
+            for (size_t i = 0; !changed && i < s->func.size(); i++) {
+                //A function with different parameters is a different function, even if it has the same name
+                ASTFunctionDecl* a = s->func[i];
+                ASTFunctionDecl* b = symbol.second.func[i];
+                changed = a->parameters.size() != b->parameters.size();
+                for (size_t j = 0; !changed && j < a->parameters.size(); j++) {
+                    changed = a->parameters[j]->type != b->parameters[j]->type;
+                }
+            }
+
+            delete s->value;
+            *s = symbol.second;
+        }
+    }
+
+    //The values now belong to the outer scope, so they must not be freed with the inner one
+    stack.pop_back();
+    return changed;
+}
+
+/*
+ * Removes scopes until only the given number are left, such as the scopes left behind when a program stops with an error.
+ */
+void SymbolTable::unwind(size_t depth) {
+    while (stack.size() > depth) {
+        pop();
+    }
+}
+
+/*
+ * The number of scopes on the stack.
+ */
+size_t SymbolTable::getDepth() {
+    return stack.size();
+}
+
 /*
  * Returns a pointer to the innermost Scope
  */
@@ -31,6 +98,70 @@ Scope* SymbolTable::top() {
 }
 
 
+/*
+ * The number of scopes pushed and identifiers looked up so far.
+ */
+long long SymbolTable::getPushes() {
+    return pushes;
+}
+
+long long SymbolTable::getLookups() {
+    return lookups;
+}
+
+
+/*
+ * Records the global symbol each identifier named the first time it was looked up, until it is set to null.
+ * A statement which looks up the same globals as when it was last checked does not need checking again.
+ */
+void SymbolTable::setLookupLog(map<string, string>* log) {
+    this->lookupLog = log;
+}
+
+void SymbolTable::logLookup(const string& id) {
+    if (lookupLog->count(id) == 0) {
+        (*lookupLog)[id] = describeGlobal(id);
+    }
+}
+
+
+/*
+ * Describes the type of a global variable, or the return and parameter types of each overload of a global function.
+ * Empty if the identifier is not declared in the global scope.
+ */
+string SymbolTable::describeGlobal(const string& id) {
+    auto symbol = stack.front().find(id);
+    if (symbol == stack.front().end()) {
+        return "";
+    }
+
+    string description = typeToString(symbol->second.type);
+    for (ASTFunctionDecl* func : symbol->second.func) {
+        description += "(";
+        for (ASTFormalParam* param : func->parameters) {
+            description += typeToString(param->type) + ",";
+        }
+        description += ")";
+    }
+
+    return description;
+}
+
+
+/*
+ * Checks if the innermost declaration of an identifier is in the global scope.
+ */
+bool SymbolTable::isGlobal(const string& id) {
+    for (auto i = stack.rbegin(); i != stack.rend() - 1; i++) {
+        if (i->find(id) != i->end()) {
+            return false;
+        }
+    }
+
+    return stack.front().count(id) != 0;
+}
+
+
 
 /*
  * Symbol Table Functions
@@ -40,6 +171,10 @@ Scope* SymbolTable::top() {
  * Checks if a variable is declared in any scope
  */
 bool SymbolTable::isDeclared(const string& id) {
+    lookups++;
+    if (lookupLog != nullptr) {
+        logLookup(id);
+    }
 
     //Look through each scope, starting with the innermost
     auto i = stack.rbegin(); //Start from the last added scope
@@ -67,6 +202,10 @@ bool SymbolTable::isDeclared(const string& id) {
  * Checks if a function is declared in any scope
  */
 bool SymbolTable::isDeclared(const string& id, vector<VariableType>* types) {
+    lookups++;
+    if (lookupLog != nullptr) {
+        logLookup(id);
+    }
 
     //Look through each scope, starting with the innermost
     auto i = stack.rbegin(); //Start from the last added scope
@@ -148,6 +287,7 @@ void SymbolTable::declare(ASTVariableDecl* node) {
  * Overloaded functions must have the same return type.
  * Since we assume that functions can only be declared in the global scope,
  * we can also assume that top() is the global (and only) scope.
+ * The globals kept from earlier programs may be in a scope below it, their functions can be declared again.
  */
 void SymbolTable::declare(ASTFunctionDecl* node) {
 
@@ -160,8 +300,8 @@ void SymbolTable::declare(ASTFunctionDecl* node) {
     }
 
 
-    //Check if the function is already declared in the program
-    if (isDeclared(id, &paramTypes)) {
+    //Check if the function is already declared in the current scope
+    if (isDeclaredScope(id, &paramTypes)) {
         //It is already declared, throw an error
 
         //Create the error message
@@ -183,7 +323,7 @@ void SymbolTable::declare(ASTFunctionDecl* node) {
     else {
         //It is not declared, check if we are overloading
 
-        if (isDeclared(id)) {
+        if (isDeclaredScope(id)) {
             //We are just overloading, check if return types are the same.
 
             Symbol* s = &(top()->find(id)->second);
@@ -219,9 +359,11 @@ void SymbolTable::declare(ASTFunctionDecl* node) {
  * Take a formal parameter and declare it as a variable in the scope
  */
 void SymbolTable::declare(ASTFormalParam* node) {
-    auto declaration = new ASTVariableDecl(node->identifier, node->type, nullptr, node->lineNum);
-    declare(declaration);
-    delete declaration;
+    ASTVariableDecl declaration(node->identifier, node->type, nullptr, node->lineNum);
+    declare(&declaration);
+
+    //The identifier still belongs to the parameter
+    declaration.identifier = nullptr;
 }
 
 
@@ -229,7 +371,16 @@ void SymbolTable::declare(ASTFormalParam* node) {
  * Assign a new value to a bool variable in the table
  */
 void SymbolTable::assign(const string& id, bool value) {
-    findSymbol(id)->second.value = new ASTLiteralBool(value, 0);
+    Symbol* symbol = &findSymbol(id)->second;
+
+    //Reuse the stored literal if it has the same type, rather than allocating a new one
+    if (symbol->value != nullptr && symbol->value->getType() == BOOL) {
+        ((ASTLiteralBool*) symbol->value)->b = value;
+    }
+    else {
+        delete symbol->value;
+        symbol->value = new ASTLiteralBool(value, 0);
+    }
 }
 
 
@@ -237,7 +388,16 @@ void SymbolTable::assign(const string& id, bool value) {
  * Assign a new value to a float variable in the table
  */
 void SymbolTable::assign(const string& id, float value) {
-    findSymbol(id)->second.value = new ASTLiteralFloat(value, 0);
+    Symbol* symbol = &findSymbol(id)->second;
+
+    //Reuse the stored literal if it has the same type, rather than allocating a new one
+    if (symbol->value != nullptr && symbol->value->getType() == FLOAT) {
+        ((ASTLiteralFloat*) symbol->value)->f = value;
+    }
+    else {
+        delete symbol->value;
+        symbol->value = new ASTLiteralFloat(value, 0);
+    }
 }
 
 
@@ -245,15 +405,33 @@ void SymbolTable::assign(const string& id, float value) {
  * Assign a new value to a int variable in the table
  */
 void SymbolTable::assign(const string& id, int value) {
-    findSymbol(id)->second.value = new ASTLiteralInt(value, 0);
+    Symbol* symbol = &findSymbol(id)->second;
+
+    //Reuse the stored literal if it has the same type, rather than allocating a new one
+    if (symbol->value != nullptr && symbol->value->getType() == INT) {
+        ((ASTLiteralInt*) symbol->value)->i = value;
+    }
+    else {
+        delete symbol->value;
+        symbol->value = new ASTLiteralInt(value, 0);
+    }
 }
 
 
 /*
  * Assign a new value to a string variable in the table
  */
-void SymbolTable::assign(const string& id, const string& value) {
-    findSymbol(id)->second.value = new ASTLiteralString(value, 0);
+void SymbolTable::assign(const string& id, const TeaString& value) {
+    Symbol* symbol = &findSymbol(id)->second;
+
+    //Reuse the stored literal if it has the same type, rather than allocating a new one
+    if (symbol->value != nullptr && symbol->value->getType() == STRING) {
+        ((ASTLiteralString*) symbol->value)->s = value;
+    }
+    else {
+        delete symbol->value;
+        symbol->value = new ASTLiteralString(value, 0);
+    }
 }
 
 
@@ -309,6 +487,10 @@ ASTFunctionDecl * SymbolTable::getFunction(const string &s, vector<VariableType>
  * Check if a variable is declared in the current scope.
  */
 bool SymbolTable::isDeclaredScope(const string& id) {
+    lookups++;
+    if (lookupLog != nullptr) {
+        logLookup(id);
+    }
 
     if (top()->find(id) == top()->end()) {
         //It is not in the table
@@ -323,11 +505,53 @@ bool SymbolTable::isDeclaredScope(const string& id) {
 }
 
 
+/*
+ * Check if a function with the same parameters is declared in the current scope.
+ */
+bool SymbolTable::isDeclaredScope(const string& id, vector<VariableType>* types) {
+    lookups++;
+    if (lookupLog != nullptr) {
+        logLookup(id);
+    }
+
+    auto symbol = top()->find(id);
+    if (symbol == top()->end()) {
+        //It is not in the table
+        return false;
+    }
+
+    //Check each declaration of the function for one with the same parameters
+    for (ASTFunctionDecl* ast : symbol->second.func) {
+        if (ast->parameters.size() != types->size()) {
+            continue;
+        }
+
+        bool output = true;
+        for (size_t j = 0; j < types->size(); j++) {
+            if (ast->parameters[j]->type != (*types)[j]) {
+                output = false;
+                break;
+            }
+        }
+
+        if (output) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
 /*
  * Finds a key & value pair int the symbol table.
  * We assume that the symbol is actually declared.
  */
 map<string, Symbol>::iterator SymbolTable::findSymbol(const string& id) {
+    lookups++;
+    if (lookupLog != nullptr) {
+        logLookup(id);
+    }
 
     //Look through each scope, starting with the innermost
     auto i = stack.rbegin(); //Start from the last added scope
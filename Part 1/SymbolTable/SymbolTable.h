@@ -56,21 +56,36 @@ public:
     void assign(const string& id, bool value);
     void assign(const string& id, float value);
     void assign(const string& id, int value);
-    void assign(const string& id, const string& value);
+    void assign(const string& id, const TeaString& value);
 
 
     //Stack Functions
 
     void push();
     void pop();
+    bool merge();
+    void unwind(size_t depth);
+    size_t getDepth();
     Scope* top();
 
+    long long getPushes();
+    long long getLookups();
+
+    void setLookupLog(map<string, string>* log);
+    string describeGlobal(const string& id);
+    bool isGlobal(const string& id);
+
 
 
 private:
     vector<Scope> stack;      //The stack of scopes
+    long long pushes;         //Number of scopes pushed
+    long long lookups;        //Number of identifiers looked up
+    map<string, string>* lookupLog;     //The global each identifier named when it was first looked up, if set
 
     bool isDeclaredScope(const string& id);
+    void logLookup(const string& id);
+    bool isDeclaredScope(const string& id, vector<VariableType>* types);
 };
 
 
@@ -0,0 +1,146 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../Driver/Protocol.h"
+
+using namespace std;
+
+
+int submit(const string& socketPath, const string& source, bool echo);
+
+
+
+/*
+ * Expected Arguments: [Options] Socket path, File name
+ *
+ * Sends a TeaLang script to a server started with TeaLang --serve=path, printing its output and exiting with its
+ * exit status. The client does not link the compiler, so it starts much faster than TeaLang itself.
+ *
+ * Options:
+ *      --repeat=N          Send the script N times, then print the mean request latency and requests per second
+ *                          to stderr. Only the output of the first request is printed.
+ */
+int main(int argc, char** argv) {
+
+    int repeat = 1;
+    vector<string> arguments;
+
+    //Read the argument list
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.compare(0, 9, "--repeat=") == 0) {
+            repeat = atoi(arg.c_str() + 9);
+
+            if (repeat < 1) {
+                cerr << "Repeat must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg.compare(0, 2, "--") == 0) {
+            cerr << "Unknown Option " << arg << endl;
+            exit(EINVAL);
+        }
+        else {
+            arguments.push_back(arg);
+        }
+    }
+
+    if (arguments.size() != 2) {
+        cerr << "Expected a socket path and a file name" << endl;
+        exit(EINVAL);
+    }
+
+
+    //Read the file
+    ifstream f(arguments[1]);
+    if (!f.is_open()) {
+        cerr << "File could not be opened" << endl;
+        exit(EBADF);
+    }
+
+    string source;
+    string line;
+    while (getline(f, line)) {
+        source.append(line);
+        source.append("\n");
+    }
+
+
+    auto start = chrono::steady_clock::now();
+    int status = 0;
+
+    for (int i = 0; i < repeat; i++) {
+        status = submit(arguments[0], source, i == 0);
+    }
+
+    if (repeat > 1) {
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << repeat << " requests, " << fixed << setprecision(3) << 1000 * seconds / repeat << " ms mean latency, "
+             << setprecision(1) << repeat / seconds << " requests/s" << endl;
+    }
+
+    return status;
+}
+
+
+/*
+ * Sends a script to the server and waits for it to finish.
+ * Returns the script's exit status.
+ */
+int submit(const string& socketPath, const string& source, bool echo) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        cerr << "Socket path " << socketPath << " is too long" << endl;
+        exit(EINVAL);
+    }
+    strcpy(address.sun_path, socketPath.c_str());
+
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0 || connect(connection, (sockaddr*) &address, sizeof(address)) != 0) {
+        cerr << "Server at " << socketPath << " could not be reached: " << strerror(errno) << endl;
+        exit(ECONNREFUSED);
+    }
+
+    if (!sendAll(connection, source.data(), source.size()) || shutdown(connection, SHUT_WR) != 0) {
+        cerr << "Script could not be sent" << endl;
+        exit(EPIPE);
+    }
+
+
+    //Print the output as it arrives, until the server sends the exit status
+    char type;
+    string payload;
+    int status = -1;
+
+    while (status < 0 && readFrame(connection, &type, &payload)) {
+        if (type == FRAME_OUTPUT && echo) {
+            sendAll(STDOUT_FILENO, payload.data(), payload.size());
+        }
+        else if (type == FRAME_ERROR && echo) {
+            cerr << payload << endl;
+        }
+        else if (type == FRAME_STATUS) {
+            status = atoi(payload.c_str());
+        }
+    }
+
+    close(connection);
+
+    if (status < 0) {
+        cerr << "Server closed the connection before the script finished" << endl;
+        return 1;
+    }
+    return status;
+}
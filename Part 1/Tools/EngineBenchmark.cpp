@@ -0,0 +1,176 @@
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <spawn.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Engine/Engine.h"
+
+using namespace std;
+
+
+void report(const string& name, int runs, double seconds);
+int spawnRuns(const string& executable, const string& fileName, int runs);
+
+
+
+/*
+ * Expected Arguments: [Options] File name
+ *
+ * Measures how many times a second a script can be run through libtealang, compiling it once and then running
+ * it many times, both with no globals and in a session which keeps them between runs.
+ * The output of the script is passed to a callback which only counts it.
+ *
+ * Options:
+ *      --runs=N            Run the script N times in each mode, 1000 by default
+ *      --spawn=path        Also run the TeaLang executable at path N times, one process for each run, to compare
+ *                          with starting a process for every script
+ */
+int main(int argc, char** argv) {
+
+    int runs = 1000;
+    string executable;
+    string fileName;
+
+    //Read the argument list
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.compare(0, 7, "--runs=") == 0) {
+            runs = atoi(arg.c_str() + 7);
+
+            if (runs < 1) {
+                cerr << "Runs must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg.compare(0, 8, "--spawn=") == 0) {
+            executable = arg.substr(8);
+        }
+        else if (arg.compare(0, 2, "--") == 0) {
+            cerr << "Unknown Option " << arg << endl;
+            exit(EINVAL);
+        }
+        else {
+            fileName = arg;
+        }
+    }
+
+    if (fileName.empty()) {
+        cerr << "Expected a file name" << endl;
+        exit(EINVAL);
+    }
+
+
+    //Read the file
+    ifstream f(fileName);
+    if (!f.is_open()) {
+        cerr << "File could not be opened" << endl;
+        exit(EBADF);
+    }
+
+    string source;
+    string line;
+    while (getline(f, line)) {
+        source.append(line);
+        source.append("\n");
+    }
+
+
+    Engine engine;
+    long long bytes = 0;
+    EngineOutput count = [&bytes](const char*, size_t length) {
+        bytes += (long long) length;
+    };
+
+
+    //Compile once, then run with no globals each time
+    auto start = chrono::steady_clock::now();
+    shared_ptr<EngineProgram> program;
+    EngineResult result = engine.compile(source, &program);
+
+    for (int i = 0; i < runs && result.succeeded(); i++) {
+        result = engine.run(program, count);
+    }
+
+    if (!result.succeeded()) {
+        cerr << result.error << endl;
+        return result.status;
+    }
+    report("compile once, fresh globals", runs, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+
+
+    //Compile once, then run in one session, keeping the globals between runs
+    start = chrono::steady_clock::now();
+    shared_ptr<EngineSession> session = engine.createSession();
+    result = engine.compile(source, session.get(), &program);
+
+    for (int i = 0; i < runs && result.succeeded(); i++) {
+        result = engine.run(program, session.get(), count);
+    }
+
+    if (!result.succeeded()) {
+        cerr << result.error << endl;
+        return result.status;
+    }
+    report("compile once, session", runs, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+
+
+    //Start a process for each run
+    if (!executable.empty()) {
+        start = chrono::steady_clock::now();
+        int status = spawnRuns(executable, fileName, runs);
+
+        if (status != 0) {
+            cerr << executable << " exited with status " << status << endl;
+            return status;
+        }
+        report("process per run", runs, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+
+    cout << bytes / (2 * runs) << " bytes of output per run" << endl;
+    return 0;
+}
+
+
+/*
+ * Prints the mean time of a run and the number of runs a second.
+ */
+void report(const string& name, int runs, double seconds) {
+    cout << left << setw(30) << name << right << fixed << setprecision(3) << setw(10) << 1000 * seconds / runs
+         << " ms/run" << setprecision(1) << setw(12) << runs / seconds << " runs/s" << endl;
+}
+
+
+/*
+ * Runs the TeaLang executable on a script, one process after another, discarding their output.
+ * Returns the first non-zero exit status, or 0 if every run succeeded.
+ */
+int spawnRuns(const string& executable, const string& fileName, int runs) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+    char* arguments[] = {(char*) executable.c_str(), (char*) fileName.c_str(), nullptr};
+    int status = 0;
+
+    for (int i = 0; i < runs && status == 0; i++) {
+        pid_t pid;
+        if (posix_spawn(&pid, executable.c_str(), &actions, nullptr, arguments, environ) != 0) {
+            status = ENOENT;
+            break;
+        }
+
+        int result;
+        waitpid(pid, &result, 0);
+        status = WIFEXITED(result) ? WEXITSTATUS(result) : 1;
+    }
+
+    posix_spawn_file_actions_destroy(&actions);
+    return status;
+}
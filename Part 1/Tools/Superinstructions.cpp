@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Visitor/IntepreterVisitor.h"
+#include "../Visitor/OptimiserVisitor.h"
+#include "../Visitor/SemanticVisitor.h"
+#include "../Parser/Parser.h"
+
+#define DEFAULT_SUPERINSTRUCTIONS 12                        //Number of superinstructions generated
+#define DEFAULT_OUTPUT "Visitor/Superinstructions.inc"      //Relative to the source directory
+
+using namespace std;
+
+
+/*
+ * A pattern of nodes which can be run by a single superinstruction, and how often it was run.
+ */
+struct Pattern {
+    string node;                //BinOp or Assignment
+    string left;                //Class of the binary operation's left operand
+    string right;               //Class of the binary operation's right operand
+    long long count;            //Number of times the pattern was run
+    long long saved;            //Number of dispatches the superinstruction saves
+};
+
+
+ASTProgram* load(const string& fileName);
+long long run(ASTProgram* program, bool superinstructions, map<ASTNode*, long long>* profile, double* seconds);
+string leaf(ASTExpression* expression, int* dispatches);
+void addPattern(vector<Pattern>& patterns, const string& node, ASTBinOp* binOp, long long count, int extra);
+
+
+
+/*
+ * Expected Arguments: [Options] File names
+ *
+ * Runs a corpus of programs with a profiling interpreter, finds the binary operations and assignments
+ * whose operands are leaves which were run most often, and writes the superinstructions for them
+ * to Superinstructions.inc, which is compiled into the interpreter.
+ * Operations in loop conditions and increments are profiled along with every other operation.
+ *
+ * Options:
+ *      --top=N             Generate N superinstructions
+ *      --output=path       Write the superinstructions to the given file instead of Visitor/Superinstructions.inc
+ *      --benchmark         Compare the dispatches and run time of each program with and without superinstructions
+ */
+int main(int argc, char** argv) {
+
+    int top = DEFAULT_SUPERINSTRUCTIONS;
+    string output = DEFAULT_OUTPUT;
+    bool benchmark = false;
+    vector<string> fileNames;
+
+    //Read the argument list
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.compare(0, 6, "--top=") == 0) {
+            top = atoi(arg.c_str() + 6);
+        }
+        else if (arg.compare(0, 9, "--output=") == 0) {
+            output = arg.substr(9);
+        }
+        else if (arg == "--benchmark") {
+            benchmark = true;
+        }
+        else if (arg.compare(0, 2, "--") == 0) {
+            cerr << "Unknown Option " << arg << endl;
+            exit(EINVAL);
+        }
+        else {
+            fileNames.push_back(arg);
+        }
+    }
+
+
+    //Compare each program with and without superinstructions
+    if (benchmark) {
+        cout << left << setw(40) << "Program" << right << setw(14) << "Dispatches" << setw(14) << "Fused"
+             << setw(11) << "Saved" << setw(12) << "Time (s)" << setw(12) << "Fused (s)" << endl;
+
+        long long totalDispatches = 0;
+        long long totalFused = 0;
+        double totalTime = 0;
+        double totalFusedTime = 0;
+
+        for (const string& fileName : fileNames) {
+            ASTProgram* program = load(fileName);
+
+            double time, fusedTime;
+            long long dispatches = run(program, false, nullptr, &time);
+            long long fused = run(program, true, nullptr, &fusedTime);
+
+            cout << left << setw(40) << fileName << right << setw(14) << dispatches << setw(14) << fused
+                 << setw(10) << fixed << setprecision(1) << 100.0 * (dispatches - fused) / dispatches << "%"
+                 << setw(12) << setprecision(3) << time << setw(12) << fusedTime << endl;
+
+            totalDispatches += dispatches;
+            totalFused += fused;
+            totalTime += time;
+            totalFusedTime += fusedTime;
+        }
+
+        cout << left << setw(40) << "Total" << right << setw(14) << totalDispatches << setw(14) << totalFused
+             << setw(10) << fixed << setprecision(1) << 100.0 * (totalDispatches - totalFused) / totalDispatches << "%"
+             << setw(12) << setprecision(3) << totalTime << setw(12) << totalFusedTime << endl;
+
+        return 0;
+    }
+
+
+    //Profile every program without superinstructions, so that every operand is counted
+    vector<Pattern> patterns;
+    long long totalDispatches = 0;
+
+    for (const string& fileName : fileNames) {
+        ASTProgram* program = load(fileName);
+
+        map<ASTNode*, long long> profile;
+        double time;
+        totalDispatches += run(program, false, &profile, &time);
+
+        for (auto& entry : profile) {
+            auto binOp = dynamic_cast<ASTBinOp*>(entry.first);
+            auto assignment = dynamic_cast<ASTAssignment*>(entry.first);
+
+            //Reduced multiplications are already handled by the enclosing loop
+            if (binOp != nullptr && binOp->induction == nullptr) {
+                addPattern(patterns, "BinOp", binOp, entry.second, 0);
+            }
+            else if (assignment != nullptr) {
+                auto value = dynamic_cast<ASTBinOp*>(assignment->value);
+                if (value != nullptr && value->induction == nullptr) {
+                    addPattern(patterns, "Assignment", value, entry.second, 1);
+                }
+            }
+        }
+    }
+
+
+    //Keep the patterns which save the most dispatches
+    sort(patterns.begin(), patterns.end(), [](const Pattern& a, const Pattern& b) {
+        return a.saved > b.saved;
+    });
+
+    if (patterns.size() > (size_t) top) {
+        patterns.resize(top);
+    }
+
+
+    ofstream f(output);
+    if (!f.is_open()) {
+        cerr << "File " << output << " could not be opened" << endl;
+        exit(EBADF);
+    }
+
+    f << "//Generated by the Superinstructions tool, do not edit." << endl;
+    f << "//Profiled " << fileNames.size() << " programs, running " << totalDispatches << " dispatches." << endl;
+    f << "//Each superinstruction is followed by the number of times it ran and the dispatches it saved." << endl;
+    f << endl;
+
+    for (Pattern& pattern : patterns) {
+        string entry = "SUPERINSTRUCTION(" + pattern.node + ", " + pattern.left + ", " + pattern.right + ")";
+        f << left << setw(64) << entry << "//" << pattern.count << ", " << pattern.saved << endl;
+
+        cout << left << setw(64) << entry << right << setw(14) << pattern.count << setw(14) << pattern.saved << endl;
+    }
+
+    f.close();
+
+    return 0;
+}
+
+
+/*
+ * Reads, parses, checks and optimises a program in the same way as the interpreter.
+ */
+ASTProgram* load(const string& fileName) {
+
+    ifstream f(fileName);
+    if (!f.is_open()) {
+        cerr << "File " << fileName << " could not be opened" << endl;
+        exit(EBADF);
+    }
+
+    string program;
+    string tmp;
+    while (getline(f, tmp)) {
+        program.append(tmp);
+        program.append("\n");
+    }
+
+    Parser p = Parser(&program);
+    ASTProgram* node = p.parseProgram();
+
+    SemanticVisitor semantic;
+    node->accept(&semantic);
+
+    OptimiserVisitor optimiser;
+    node->accept(&optimiser);
+
+    return node;
+}
+
+
+/*
+ * Interprets a program, discarding its output.
+ * Returns the number of dispatches, and the run time in seconds.
+ */
+long long run(ASTProgram* program, bool superinstructions, map<ASTNode*, long long>* profile, double* seconds) {
+
+    int discard = open("/dev/null", O_WRONLY);
+    OutputSink output(discard, FLUSH_FULL);
+
+    InterpreterVisitor interpreter;
+    interpreter.setSuperinstructions(superinstructions);
+    interpreter.setProfile(profile);
+    interpreter.setOutput(&output);
+
+    auto start = chrono::steady_clock::now();
+    program->accept(&interpreter);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    output.flush();
+    close(discard);
+
+    *seconds = elapsed.count();
+    return interpreter.getDispatches();
+}
+
+
+/*
+ * Returns the class of an operand which can be part of a superinstruction, or an empty string.
+ * Also returns the number of dispatches needed to evaluate it, identifiers also visit their value.
+ */
+string leaf(ASTExpression* expression, int* dispatches) {
+    *dispatches = 1;
+
+    if (dynamic_cast<ASTIdentifier*>(expression) != nullptr) {
+        *dispatches = 2;
+        return "ASTIdentifier";
+    }
+    if (dynamic_cast<ASTLiteralBool*>(expression) != nullptr) {
+        return "ASTLiteralBool";
+    }
+    if (dynamic_cast<ASTLiteralFloat*>(expression) != nullptr) {
+        return "ASTLiteralFloat";
+    }
+    if (dynamic_cast<ASTLiteralInt*>(expression) != nullptr) {
+        return "ASTLiteralInt";
+    }
+    if (dynamic_cast<ASTLiteralString*>(expression) != nullptr) {
+        return "ASTLiteralString";
+    }
+
+    return "";
+}
+
+
+/*
+ * Adds the number of times a binary operation was run to the count of its pattern.
+ * Extra is the number of dispatches saved on top of the operands, 1 for the operation itself in an assignment.
+ */
+void addPattern(vector<Pattern>& patterns, const string& node, ASTBinOp* binOp, long long count, int extra) {
+
+    int lDispatches, rDispatches;
+    string left = leaf(binOp->lExpression, &lDispatches);
+    string right = leaf(binOp->rExpression, &rDispatches);
+
+    if (left.empty() || right.empty()) {
+        return;
+    }
+
+    long long saved = count * (lDispatches + rDispatches + extra);
+
+    for (Pattern& pattern : patterns) {
+        if (pattern.node == node && pattern.left == left && pattern.right == right) {
+            pattern.count += count;
+            pattern.saved += saved;
+            return;
+        }
+    }
+
+    patterns.push_back(Pattern{node, left, right, count, saved});
+}
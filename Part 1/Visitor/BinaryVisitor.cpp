@@ -0,0 +1,247 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+#include "BinaryVisitor.h"
+
+
+BinaryVisitor::BinaryVisitor() {
+    this->index = BINARY_AST_NONE;
+    this->source = BINARY_AST_NONE;
+}
+
+
+/*
+ * Keeps the source of the program in the file, so a reader can check it was written for the same source.
+ */
+void BinaryVisitor::setSource(const string& source) {
+    this->source = addString(source.data(), source.size());
+}
+
+
+/*
+ * Writes the program visited to a file.
+ * The file is written under a temporary name first, so a reader never sees it half written.
+ */
+void BinaryVisitor::write(const string& fileName) {
+
+    BinaryHeader header = {};
+    memcpy(header.magic, BINARY_AST_MAGIC, BINARY_AST_MAGIC_LENGTH);
+    header.version = BINARY_AST_VERSION;
+    header.root = index;
+    header.nodeCount = (uint32_t) nodes.size();
+    header.childCount = (uint32_t) children.size();
+    header.stringCount = (uint32_t) strings.size();
+    header.stringBytes = (uint32_t) characters.size();
+    header.source = source;
+
+    string temporary = fileName + ".tmp" + to_string(getpid());
+    ofstream f(temporary, ios::binary);
+
+    if (!f.is_open()) {
+        throw runtime_error("File " + fileName + " could not be opened.");
+    }
+
+    f.write((const char*) &header, sizeof(header));
+    f.write((const char*) nodes.data(), nodes.size() * sizeof(BinaryNode));
+    f.write((const char*) children.data(), children.size() * sizeof(uint32_t));
+    f.write((const char*) strings.data(), strings.size() * sizeof(BinaryString));
+    f.write(characters.data(), characters.size());
+    f.close();
+
+    if (!f || rename(temporary.c_str(), fileName.c_str()) != 0) {
+        unlink(temporary.c_str());
+        throw runtime_error("File " + fileName + " could not be written.");
+    }
+}
+
+
+/*
+ * Appends a node, returning its index.
+ */
+uint32_t BinaryVisitor::add(BinaryKind kind, uint8_t detail, ASTNode* node,
+                            uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    nodes.push_back(BinaryNode{kind, detail, 0, (uint32_t) node->lineNum, a, b, c, d});
+    index = (uint32_t) nodes.size() - 1;
+    return index;
+}
+
+
+/*
+ * Writes a child node, returning its index.
+ */
+uint32_t BinaryVisitor::child(ASTNode* node) {
+    node->accept(this);
+    return index;
+}
+
+uint32_t BinaryVisitor::optional(ASTNode* node) {
+    return (node != nullptr) ? child(node) : BINARY_AST_NONE;
+}
+
+
+/*
+ * Adds a string to the string table, returning its index.
+ */
+uint32_t BinaryVisitor::addString(const char* data, size_t length) {
+    string s(data, length);
+
+    auto found = stringIndex.find(s);
+    if (found != stringIndex.end()) {
+        return found->second;
+    }
+
+    strings.push_back(BinaryString{(uint32_t) characters.size(), (uint32_t) length});
+    characters.append(s);
+
+    uint32_t added = (uint32_t) strings.size() - 1;
+    stringIndex[s] = added;
+    return added;
+}
+
+
+/*
+ * Writes a list of nodes, then their indices to the child array.
+ * Returns where the indices start.
+ */
+template <class T>
+uint32_t BinaryVisitor::list(const vector<T*>& elements) {
+    vector<uint32_t> indices;
+    for (T* node : elements) {
+        indices.push_back(child(node));
+    }
+
+    auto start = (uint32_t) children.size();
+    children.insert(children.end(), indices.begin(), indices.end());
+    return start;
+}
+
+
+/*
+ * Visit Functions
+ */
+
+
+void BinaryVisitor::visit(ASTProgram* node) {
+    uint32_t start = list(node->program);
+    add(B_PROGRAM, 0, node, start, (uint32_t) node->program.size(), 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTAssignment* node) {
+    uint32_t identifier = child(node->identifier);
+    uint32_t value = child(node->value);
+    add(B_ASSIGNMENT, 0, node, identifier, value, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTBinOp* node) {
+    uint32_t lExpression = child(node->lExpression);
+    uint32_t rExpression = child(node->rExpression);
+    add(B_BINOP, (uint8_t) node->op, node, lExpression, rExpression, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTBlock* node) {
+    uint32_t start = list(node->block);
+    add(B_BLOCK, 0, node, start, (uint32_t) node->block.size(), 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTFor* node) {
+    uint32_t declaration = optional(node->declaration);
+    uint32_t conditional = child(node->conditional);
+    uint32_t assignment = optional(node->assignment);
+    uint32_t block = child(node->block);
+    add(B_FOR, 0, node, declaration, conditional, assignment, block);
+}
+
+
+void BinaryVisitor::visit(ASTFormalParam* node) {
+    uint32_t identifier = child(node->identifier);
+    add(B_FORMALPARAM, (uint8_t) node->type, node, identifier, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTFunctionCall* node) {
+    uint32_t identifier = child(node->identifier);
+    uint32_t start = list(node->param);
+    add(B_FUNCTIONCALL, 0, node, identifier, start, (uint32_t) node->param.size(), 0);
+}
+
+
+void BinaryVisitor::visit(ASTFunctionDecl* node) {
+    uint32_t identifier = child(node->identifier);
+    uint32_t start = list(node->parameters);
+    uint32_t block = child(node->block);
+    add(B_FUNCTIONDECL, (uint8_t) node->returnType, node, identifier, start, (uint32_t) node->parameters.size(), block);
+}
+
+
+void BinaryVisitor::visit(ASTIdentifier* node) {
+    uint32_t s = addString(node->identifier.data(), node->identifier.size());
+    add(B_IDENTIFIER, 0, node, s, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTIf* node) {
+    uint32_t conditional = child(node->conditional);
+    uint32_t ifBlock = child(node->ifBlock);
+    uint32_t elseBlock = optional(node->elseBlock);
+    add(B_IF, 0, node, conditional, ifBlock, elseBlock, 0);
+}
+
+
+void BinaryVisitor::visit(ASTLiteralBool* node) {
+    add(B_LITERALBOOL, 0, node, node->b ? 1 : 0, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTLiteralFloat* node) {
+    uint32_t bits;
+    memcpy(&bits, &node->f, sizeof(bits));
+    add(B_LITERALFLOAT, 0, node, bits, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTLiteralInt* node) {
+    add(B_LITERALINT, 0, node, (uint32_t) node->i, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTLiteralString* node) {
+    uint32_t s = addString(node->s.data(), node->s.length());
+    add(B_LITERALSTRING, 0, node, s, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTPrint* node) {
+    uint32_t expression = child(node->expression);
+    add(B_PRINT, 0, node, expression, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTReturn* node) {
+    uint32_t returnValue = child(node->returnValue);
+    add(B_RETURN, 0, node, returnValue, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTUnary* node) {
+    uint32_t expression = child(node->expression);
+    add(B_UNARY, (uint8_t) node->op, node, expression, 0, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTVariableDecl* node) {
+    uint32_t identifier = child(node->identifier);
+    uint32_t value = child(node->value);
+    add(B_VARIABLEDECL, (uint8_t) node->type, node, identifier, value, 0, 0);
+}
+
+
+void BinaryVisitor::visit(ASTWhile* node) {
+    uint32_t conditional = child(node->conditional);
+    uint32_t block = child(node->block);
+    add(B_WHILE, 0, node, conditional, block, 0, 0);
+}
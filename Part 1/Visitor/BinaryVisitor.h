@@ -0,0 +1,68 @@
+#ifndef CPS2000_ASSIGNMENT_BINARYVISITOR_H
+#define CPS2000_ASSIGNMENT_BINARYVISITOR_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "Visitor.h"
+#include "../AST/AST.h"
+#include "../Binary/BinaryFormat.h"
+
+using namespace std;
+
+
+/*
+ * Writes a program to a binary AST file, which can be loaded by the BinaryLoader instead of parsing the source.
+ * Only the tree built by the parser is written, not any annotations added by the optimiser or interpreter.
+ */
+class BinaryVisitor : public Visitor {
+public:
+    BinaryVisitor();
+
+    void write(const string& fileName);
+    void setSource(const string& source);
+
+    void visit(ASTProgram*) override;
+    void visit(ASTAssignment*) override;
+    void visit(ASTBinOp*) override;
+    void visit(ASTBlock*) override;
+    void visit(ASTFor*) override;
+    void visit(ASTFormalParam*) override;
+    void visit(ASTFunctionCall*) override;
+    void visit(ASTFunctionDecl*) override;
+    void visit(ASTIdentifier*) override;
+    void visit(ASTIf*) override;
+    void visit(ASTLiteralBool*) override;
+    void visit(ASTLiteralFloat*) override;
+    void visit(ASTLiteralInt*) override;
+    void visit(ASTLiteralString*) override;
+    void visit(ASTPrint*) override;
+    void visit(ASTReturn*) override;
+    void visit(ASTUnary*) override;
+    void visit(ASTVariableDecl*) override;
+    void visit(ASTWhile*) override;
+
+
+private:
+    vector<BinaryNode> nodes;
+    vector<uint32_t> children;
+    vector<BinaryString> strings;
+    string characters;
+    map<string, uint32_t> stringIndex;  //Each distinct string is only stored once
+
+    uint32_t index;                     //Index of the last node written
+    uint32_t source;                    //Index of the string holding the source, if it is kept
+
+    uint32_t add(BinaryKind kind, uint8_t detail, ASTNode* node, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+    uint32_t child(ASTNode* node);
+    uint32_t optional(ASTNode* node);
+    uint32_t addString(const char* data, size_t length);
+
+    template <class T>
+    uint32_t list(const vector<T*>& elements);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_BINARYVISITOR_H
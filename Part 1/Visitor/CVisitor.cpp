@@ -0,0 +1,581 @@
+#include <cstdio>
+#include "CVisitor.h"
+
+string cType(VariableType t);
+string cVariable(const string& id);
+string cString(const string& s);
+string cDefault(VariableType t);
+
+
+/*
+ * Runtime support included at the start of every generated program.
+ * Printing matches the formatting used by the interpreter.
+ */
+const string prelude =
+        "#include <stdbool.h>\n"
+        "#include <stdio.h>\n"
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "\n"
+        "static const char* tl_concat(const char* a, const char* b) {\n"
+        "    size_t aLength = strlen(a);\n"
+        "    size_t bLength = strlen(b);\n"
+        "    char* s = malloc(aLength + bLength + 1);\n"
+        "    memcpy(s, a, aLength);\n"
+        "    memcpy(s + aLength, b, bLength + 1);\n"
+        "    return s;\n"
+        "}\n"
+        "\n"
+        "static void tl_print_bool(bool b) { puts(b ? \"true\" : \"false\"); }\n"
+        "static void tl_print_float(float f) { printf(\"%g\\n\", (double) f); }\n"
+        "static void tl_print_int(int i) { printf(\"%d\\n\", i); }\n"
+        "static void tl_print_string(const char* s) { puts(s); }\n"
+        "\n";
+
+
+CVisitor::CVisitor() {
+    this->code = &mainBody;
+    this->indent = 1;
+    this->depth = 0;
+    this->temporaries = 0;
+    this->inFunction = false;
+    this->functionType = INT;
+    this->returnedType = INT;
+}
+
+
+/*
+ * Returns the complete C program.
+ * Should only be called after visiting the ASTProgram.
+ */
+string CVisitor::getSource() {
+    return prelude + globals + "\n" + functions + "int main(void) {\n" + mainBody + "    return 0;\n}\n";
+}
+
+
+/*
+ * Returns the C name of a function.
+ * A code is appended for each parameter type, so that overloaded functions have different names.
+ */
+string CVisitor::mangle(ASTFunctionDecl* node) {
+    string name = "f_" + node->identifier->identifier + "__";
+
+    for (ASTFormalParam* param : node->parameters) {
+        switch (param->type) {
+            case BOOL:   name += "b"; break;
+            case FLOAT:  name += "f"; break;
+            case INT:    name += "i"; break;
+            case STRING: name += "s"; break;
+            default:     break;
+        }
+    }
+
+    return name;
+}
+
+
+/*
+ * Returns the C type used to store a variable type.
+ */
+string cType(VariableType t) {
+    switch (t) {
+        case BOOL:   return "bool";
+        case FLOAT:  return "float";
+        case INT:    return "int";
+        case STRING: return "const char*";
+        default:     throw runtime_error("Type " + typeToString(t) + " cannot be compiled to C.");
+    }
+}
+
+
+/*
+ * Returns the C value returned by a function which reaches the end of its body without a return.
+ */
+string cDefault(VariableType t) {
+    switch (t) {
+        case BOOL:   return "false";
+        case FLOAT:  return "0.0f";
+        case INT:    return "0";
+        case STRING: return "\"\"";
+        default:     throw runtime_error("Type " + typeToString(t) + " cannot be compiled to C.");
+    }
+}
+
+
+/*
+ * Returns the C name of a variable.
+ * A prefix is added so that variables cannot clash with C keywords or the runtime functions.
+ */
+string cVariable(const string& id) {
+    return "v_" + id;
+}
+
+
+/*
+ * Converts a string into a C string literal.
+ */
+string cString(const string& s) {
+    string literal = "\"";
+
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            literal += '\\';
+            literal += c;
+        }
+        else if (c == '\n') {
+            literal += "\\n";
+        }
+        else if (isprint((unsigned char) c)) {
+            literal += c;
+        }
+        else {
+            //Use an octal escape for anything else
+            char escape[5];
+            snprintf(escape, sizeof(escape), "\\%03o", (unsigned char) c);
+            literal += escape;
+        }
+    }
+
+    return literal + "\"";
+}
+
+
+/*
+ * Writes a line of code to the function currently being translated.
+ */
+void CVisitor::line(const string& s) {
+    code->append(indent * 4, ' ');
+    code->append(s);
+    code->append("\n");
+}
+
+
+/*
+ * Opens a new C block, which also acts as a new scope.
+ */
+void CVisitor::beginScope() {
+    line("{");
+    indent++;
+    depth++;
+    table.push();
+}
+
+
+/*
+ * Closes the innermost C block.
+ */
+void CVisitor::endScope() {
+    table.pop();
+    depth--;
+    indent--;
+    line("}");
+}
+
+
+/*
+ * Records a global variable read or assigned by a function, which a caller's local could hide in the interpreter.
+ */
+void CVisitor::useVariable(const string& id, int lineNum) {
+    if (inFunction && table.isGlobal(id) && globalUses.count(id) == 0) {
+        globalUses[id] = lineNum;
+    }
+}
+
+
+/*
+ * Stores a value in a new temporary variable and returns the variable's name.
+ */
+string CVisitor::temporary(VariableType type, const string& value) {
+    string name = "t" + to_string(temporaries++);
+    line(cType(type) + " " + name + " = " + value + ";");
+
+    return name;
+}
+
+
+/*
+ * Returns a C expression converting a value between types, in the same way as the interpreter.
+ */
+string CVisitor::convert(const string& value, VariableType from, VariableType to) {
+    if (from == to || to == STRING) {
+        return value;
+    }
+
+    return "(" + cType(to) + ") " + value;
+}
+
+
+/*
+ * Visit Functions
+ */
+
+
+void CVisitor::visit(ASTProgram* node) {
+
+    //Enter the global scope
+    table.push();
+
+    //Translate each statement into the body of main()
+    for (ASTStatement* statement : node->program) {
+        statement->accept(this);
+    }
+
+    //Exit the scope
+    table.pop();
+
+    //A local anywhere in the program could be the one a function's global resolves to when it is called
+    for (auto& use : globalUses) {
+        if (localNames.count(use.first) != 0) {
+            throw runtime_error("Line " + to_string(use.second) + ": The global " + use.first + " is used in a function "
+                                "but also declared as a local, which would hide it from the function when called "
+                                "in its scope, so it cannot be compiled to C.");
+        }
+    }
+}
+
+
+void CVisitor::visit(ASTAssignment* node) {
+
+    //Evaluate the expression
+    node->value->accept(this);
+
+    //Convert the value to the variable's type and assign it
+    string id = node->identifier->identifier;
+    useVariable(id, node->lineNum);
+    line(cVariable(id) + " = " + convert(operand, returnedType, table.getType(id)) + ";");
+}
+
+
+void CVisitor::visit(ASTBinOp* node) {
+
+    //Evaluate both operands, left first
+    node->lExpression->accept(this);
+    string lOperand = operand;
+    VariableType lType = returnedType;
+
+    node->rExpression->accept(this);
+    string rOperand = operand;
+    VariableType rType = returnedType;
+
+
+    //Pick the C operator
+    string op;
+    switch (node->op) {
+        case MULT:             op = "*";  break;
+        case DIVIDE:           op = "/";  break;
+        case PLUS:             op = "+";  break;
+        case MINUS:            op = "-";  break;
+        case LESSTHAN:         op = "<";  break;
+        case LESSTHANEQUAL:    op = "<="; break;
+        case GREATERTHAN:      op = ">";  break;
+        case GREATERTHANEQUAL: op = ">="; break;
+        case EQUALS:           op = "=="; break;
+        case NOTEQUALS:        op = "!="; break;
+        case AND:              op = "&&"; break;
+        case OR:               op = "||"; break;
+        default:
+            throw runtime_error("Line " + to_string(node->lineNum) + ": Unknown Operator.");
+    }
+
+    bool isComparison = (node->op != MULT && node->op != DIVIDE && node->op != PLUS && node->op != MINUS);
+
+
+    //Use the same types as the interpreter
+    if (node->op == AND || node->op == OR) {
+        //Both operands have already been evaluated, so short circuiting does not change the result
+        string value = convert(lOperand, lType, BOOL) + " " + op + " " + convert(rOperand, rType, BOOL);
+        operand = temporary(BOOL, value);
+        returnedType = BOOL;
+    }
+
+    else if (lType == STRING && rType == STRING) {
+        if (node->op == PLUS) {
+            operand = temporary(STRING, "tl_concat(" + lOperand + ", " + rOperand + ")");
+            returnedType = STRING;
+        }
+        else {
+            operand = temporary(BOOL, "strcmp(" + lOperand + ", " + rOperand + ") " + op + " 0");
+            returnedType = BOOL;
+        }
+    }
+
+    else if (lType == FLOAT || rType == FLOAT) {
+        string value = convert(lOperand, lType, FLOAT) + " " + op + " " + convert(rOperand, rType, FLOAT);
+        returnedType = isComparison ? BOOL : FLOAT;
+        operand = temporary(returnedType, value);
+    }
+
+    else {
+        string l = convert(lOperand, lType, INT);
+        string r = convert(rOperand, rType, INT);
+
+        if (node->op == DIVIDE) {
+            //Division always produces a float
+            operand = temporary(FLOAT, "(float) ((double) " + l + " / (double) " + r + ")");
+            returnedType = FLOAT;
+        }
+        else if (isComparison) {
+            operand = temporary(BOOL, l + " " + op + " " + r);
+            returnedType = BOOL;
+        }
+        else {
+            //Overflow wraps around
+            operand = temporary(INT, "(int) ((unsigned) " + l + " " + op + " (unsigned) " + r + ")");
+            returnedType = INT;
+        }
+    }
+
+}
+
+
+void CVisitor::visit(ASTBlock* node) {
+    beginScope();
+
+    for (ASTStatement* statement : node->block) {
+        statement->accept(this);
+    }
+
+    endScope();
+}
+
+
+void CVisitor::visit(ASTFor* node) {
+
+    //The loop variable has its own scope
+    beginScope();
+
+    if (node->declaration != nullptr) {
+        node->declaration->accept(this);
+    }
+
+    line("while (1) {");
+    indent++;
+
+    //Check the condition
+    node->conditional->accept(this);
+    line("if (!" + convert(operand, returnedType, BOOL) + ") break;");
+
+    //Run the loop block, followed by the increment
+    node->block->accept(this);
+
+    if (node->assignment != nullptr) {
+        node->assignment->accept(this);
+    }
+
+    indent--;
+    line("}");
+
+    endScope();
+}
+
+
+void CVisitor::visit(ASTFormalParam* node) {
+    //Declare the parameter, so that its type can be found
+    table.declare(node);
+    localNames.insert(node->identifier->identifier);
+}
+
+
+void CVisitor::visit(ASTFunctionCall* node) {
+
+    //Evaluate each parameter in order
+    vector<VariableType> types;
+    string arguments;
+    for (ASTExpression* param : node->param) {
+        param->accept(this);
+
+        types.push_back(returnedType);
+        arguments += (arguments.empty() ? "" : ", ") + operand;
+    }
+
+    //Find which overload is being called
+    ASTFunctionDecl* func = table.getFunction(node->identifier->identifier, &types);
+
+    operand = temporary(func->returnType, mangle(func) + "(" + arguments + ")");
+    returnedType = func->returnType;
+}
+
+
+void CVisitor::visit(ASTFunctionDecl* node) {
+
+    //C functions cannot be nested
+    if (inFunction || depth > 0) {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Only functions declared in the global scope can be compiled to C.");
+    }
+
+    //Write the function separately from main()
+    string function;
+    code = &function;
+    inFunction = true;
+    functionType = node->returnType;
+    int mainIndent = indent;
+    indent = 0;
+
+    //Declare the parameters in a new scope
+    table.push();
+
+    string parameters;
+    for (ASTFormalParam* param : node->parameters) {
+        param->accept(this);
+        parameters += (parameters.empty() ? "" : ", ") + cType(param->type) + " " + cVariable(param->identifier->identifier);
+    }
+
+    line("static " + cType(node->returnType) + " " + mangle(node) + "(" + (parameters.empty() ? "void" : parameters) + ") {");
+    indent++;
+
+    //The block is nested inside the function, so it can declare variables with the same names as parameters
+    node->block->accept(this);
+
+    //The semantic checks allow a function to reach the end of its body, which must still return a value in C
+    line("return " + cDefault(node->returnType) + ";");
+
+    indent--;
+    line("}");
+
+    table.pop();
+
+
+    //Continue writing main()
+    functions += function + "\n";
+    code = &mainBody;
+    inFunction = false;
+    indent = mainIndent;
+
+    //Declare the function, so that calls can be resolved
+    table.declare(node);
+}
+
+
+void CVisitor::visit(ASTIdentifier* node) {
+    //Copy the variable, in case it is changed by a function called later in the same expression
+    useVariable(node->identifier, node->lineNum);
+    returnedType = table.getType(node->identifier);
+    operand = temporary(returnedType, cVariable(node->identifier));
+}
+
+
+void CVisitor::visit(ASTIf* node) {
+
+    //Check the condition
+    node->conditional->accept(this);
+    line("if (" + convert(operand, returnedType, BOOL) + ")");
+
+    node->ifBlock->accept(this);
+
+    //Check if there is an else block
+    if (node->elseBlock != nullptr) {
+        line("else");
+        node->elseBlock->accept(this);
+    }
+}
+
+
+void CVisitor::visit(ASTLiteralBool* node) {
+    operand = node->b ? "true" : "false";
+    returnedType = BOOL;
+}
+
+
+void CVisitor::visit(ASTLiteralFloat* node) {
+    //Hexadecimal floats represent the value exactly
+    char literal[64];
+    snprintf(literal, sizeof(literal), "%af", (double) node->f);
+
+    operand = literal;
+    returnedType = FLOAT;
+}
+
+
+void CVisitor::visit(ASTLiteralInt* node) {
+    operand = to_string(node->i);
+    returnedType = INT;
+}
+
+
+void CVisitor::visit(ASTLiteralString* node) {
+    operand = cString(node->s.str());
+    returnedType = STRING;
+}
+
+
+void CVisitor::visit(ASTPrint* node) {
+    node->expression->accept(this);
+
+    switch (returnedType) {
+        case BOOL:   line("tl_print_bool(" + operand + ");"); break;
+        case FLOAT:  line("tl_print_float(" + operand + ");"); break;
+        case INT:    line("tl_print_int(" + operand + ");"); break;
+        case STRING: line("tl_print_string(" + operand + ");"); break;
+        default:     break;
+    }
+}
+
+
+void CVisitor::visit(ASTReturn* node) {
+    node->returnValue->accept(this);
+
+    if (inFunction) {
+        line("return " + convert(operand, returnedType, functionType) + ";");
+    }
+    else {
+        //Returning from the global scope ends the program
+        line("return 0;");
+    }
+}
+
+
+void CVisitor::visit(ASTUnary* node) {
+    node->expression->accept(this);
+
+    if (node->op == MINUS) {
+        //Negate ints directly, anything else is negated as a float
+        if (returnedType == INT) {
+            operand = temporary(INT, "(int) (0u - (unsigned) " + operand + ")");
+        }
+        else {
+            operand = temporary(FLOAT, "-" + convert(operand, returnedType, FLOAT));
+            returnedType = FLOAT;
+        }
+    }
+    else {
+        operand = temporary(BOOL, "!" + convert(operand, returnedType, BOOL));
+        returnedType = BOOL;
+    }
+}
+
+
+void CVisitor::visit(ASTVariableDecl* node) {
+
+    //Evaluate the initial value before declaring the variable
+    node->value->accept(this);
+    string value = convert(operand, returnedType, node->type);
+
+    table.declare(node);
+
+    string name = cVariable(node->identifier->identifier);
+    if (!inFunction && depth == 0) {
+        //Variables in the global scope can be used by functions, so they are declared outside main()
+        globals += "static " + cType(node->type) + " " + name + ";\n";
+        line(name + " = " + value + ";");
+    }
+    else {
+        localNames.insert(node->identifier->identifier);
+        line(cType(node->type) + " " + name + " = " + value + ";");
+    }
+}
+
+
+void CVisitor::visit(ASTWhile* node) {
+
+    line("while (1) {");
+    indent++;
+
+    //Check the condition
+    node->conditional->accept(this);
+    line("if (!" + convert(operand, returnedType, BOOL) + ") break;");
+
+    node->block->accept(this);
+
+    indent--;
+    line("}");
+}
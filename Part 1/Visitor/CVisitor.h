@@ -0,0 +1,85 @@
+#ifndef CPS2000_ASSIGNMENT_CVISITOR_H
+#define CPS2000_ASSIGNMENT_CVISITOR_H
+
+#include <map>
+#include <set>
+#include <string>
+#include "Visitor.h"
+#include "../SymbolTable/SymbolTable.h"
+
+using namespace std;
+
+
+/*
+ * Translates a semantically checked program into a standalone C translation unit.
+ * The generated program produces the same output as the InterpreterVisitor.
+ *
+ * Every intermediate value is stored in a temporary variable so that expressions
+ * are evaluated from left to right, in the same order as the interpreter.
+ * Overloaded functions are given a different C name for each parameter list.
+ *
+ * The interpreter scopes variables dynamically, so a global used by a function is hidden by a local of the same
+ * name in whichever function called it, while in C it always names the global. A program where any local shares
+ * its name with a global used by a function is rejected rather than translated with a different meaning.
+ */
+class CVisitor : public Visitor {
+public:
+    CVisitor();
+
+    string getSource();
+
+    void visit(ASTProgram*) override;
+    void visit(ASTAssignment*) override;
+    void visit(ASTBinOp*) override;
+    void visit(ASTBlock*) override;
+    void visit(ASTFor*) override;
+    void visit(ASTFormalParam*) override;
+    void visit(ASTFunctionCall*) override;
+    void visit(ASTFunctionDecl*) override;
+    void visit(ASTIdentifier*) override;
+    void visit(ASTIf*) override;
+    void visit(ASTLiteralBool*) override;
+    void visit(ASTLiteralFloat*) override;
+    void visit(ASTLiteralInt*) override;
+    void visit(ASTLiteralString*) override;
+    void visit(ASTPrint*) override;
+    void visit(ASTReturn*) override;
+    void visit(ASTUnary*) override;
+    void visit(ASTVariableDecl*) override;
+    void visit(ASTWhile*) override;
+
+    static string mangle(ASTFunctionDecl* node);
+
+
+private:
+    SymbolTable table;          //Used to find the type of variables and resolve overloaded functions
+
+    string globals;             //Declarations of global variables
+    string functions;           //Definitions of every function
+    string mainBody;            //Statements executed by main()
+    string* code;               //The function currently being written to
+
+    int indent;                 //Indentation of the current line
+    int depth;                  //Number of scopes entered since the global scope
+    int temporaries;            //Number of temporary variables created
+    bool inFunction;            //True while translating a function declaration
+    VariableType functionType;  //Return type of the function being translated
+
+    map<string, int> globalUses;    //Globals used by functions, with the first line each is used on
+    set<string> localNames;         //Variables and parameters declared outside the global scope
+
+    //The C expression holding the value of the last expression visited and its type
+    string operand;
+    VariableType returnedType;
+
+    void line(const string& s);
+    void beginScope();
+    void endScope();
+    void useVariable(const string& id, int lineNum);
+    string temporary(VariableType type, const string& value);
+    string convert(const string& value, VariableType from, VariableType to);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_CVISITOR_H
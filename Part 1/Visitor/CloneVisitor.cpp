@@ -0,0 +1,185 @@
+#include "CloneVisitor.h"
+
+
+CloneVisitor::CloneVisitor() {
+    this->cloned = nullptr;
+    this->lineOffset = 0;
+}
+
+CloneVisitor::CloneVisitor(map<string, int> constants) {
+    this->constants = move(constants);
+    this->cloned = nullptr;
+    this->lineOffset = 0;
+}
+
+
+/*
+ * Moves every node of the copy down by a number of lines, used when a tree parsed on its own
+ * becomes part of a larger program.
+ */
+void CloneVisitor::setLineOffset(int offset) {
+    this->lineOffset = offset;
+}
+
+
+/*
+ * The line of the copy of a node.
+ */
+int CloneVisitor::line(ASTNode* node) {
+    return node->lineNum + lineOffset;
+}
+
+
+/*
+ * Copies an identifier which names a variable or function, rather than reading its value.
+ * These are never replaced by constants.
+ */
+ASTIdentifier* CloneVisitor::copyIdentifier(ASTIdentifier* node) {
+    return new ASTIdentifier(node->identifier, line(node));
+}
+
+
+/*
+ * Visit Functions
+ */
+
+
+void CloneVisitor::visit(ASTProgram* node) {
+    vector<ASTStatement*> program;
+    for (ASTStatement* statement : node->program) {
+        program.push_back(clone(statement));
+    }
+
+    cloned = new ASTProgram(program, line(node));
+}
+
+
+void CloneVisitor::visit(ASTAssignment* node) {
+    cloned = new ASTAssignment(copyIdentifier(node->identifier), clone(node->value), line(node));
+}
+
+
+void CloneVisitor::visit(ASTBinOp* node) {
+    ASTExpression* lExpression = clone(node->lExpression);
+    ASTExpression* rExpression = clone(node->rExpression);
+
+    cloned = new ASTBinOp(lExpression, node->op, rExpression, line(node));
+}
+
+
+void CloneVisitor::visit(ASTBlock* node) {
+    vector<ASTStatement*> block;
+    for (ASTStatement* statement : node->block) {
+        block.push_back(clone(statement));
+    }
+
+    cloned = new ASTBlock(block, line(node));
+}
+
+
+void CloneVisitor::visit(ASTFor* node) {
+    ASTVariableDecl* declaration = clone(node->declaration);
+    ASTExpression* conditional = clone(node->conditional);
+    ASTAssignment* assignment = clone(node->assignment);
+    ASTBlock* block = clone(node->block);
+
+    cloned = new ASTFor(declaration, conditional, assignment, block, line(node));
+}
+
+
+void CloneVisitor::visit(ASTFormalParam* node) {
+    cloned = new ASTFormalParam(copyIdentifier(node->identifier), node->type, line(node));
+}
+
+
+void CloneVisitor::visit(ASTFunctionCall* node) {
+    vector<ASTExpression*> param;
+    for (ASTExpression* p : node->param) {
+        param.push_back(clone(p));
+    }
+
+    cloned = new ASTFunctionCall(copyIdentifier(node->identifier), param, line(node));
+}
+
+
+void CloneVisitor::visit(ASTFunctionDecl* node) {
+    vector<ASTFormalParam*> parameters;
+    for (ASTFormalParam* p : node->parameters) {
+        parameters.push_back(clone(p));
+    }
+
+    cloned = new ASTFunctionDecl(node->returnType, copyIdentifier(node->identifier), parameters,
+                                 clone(node->block), line(node));
+}
+
+
+void CloneVisitor::visit(ASTIdentifier* node) {
+    //Check if the variable should be replaced by a constant
+    auto constant = constants.find(node->identifier);
+
+    if (constant != constants.end()) {
+        cloned = new ASTLiteralInt(constant->second, line(node));
+    }
+    else {
+        cloned = copyIdentifier(node);
+    }
+}
+
+
+void CloneVisitor::visit(ASTIf* node) {
+    ASTExpression* conditional = clone(node->conditional);
+    ASTBlock* ifBlock = clone(node->ifBlock);
+    ASTBlock* elseBlock = clone(node->elseBlock);
+
+    cloned = new ASTIf(conditional, ifBlock, elseBlock, line(node));
+}
+
+
+void CloneVisitor::visit(ASTLiteralBool* node) {
+    cloned = new ASTLiteralBool(node->b, line(node));
+}
+
+
+void CloneVisitor::visit(ASTLiteralFloat* node) {
+    cloned = new ASTLiteralFloat(node->f, line(node));
+}
+
+
+void CloneVisitor::visit(ASTLiteralInt* node) {
+    cloned = new ASTLiteralInt(node->i, line(node));
+}
+
+
+void CloneVisitor::visit(ASTLiteralString* node) {
+    cloned = new ASTLiteralString(node->s, line(node));
+}
+
+
+void CloneVisitor::visit(ASTPrint* node) {
+    cloned = new ASTPrint(clone(node->expression), line(node));
+}
+
+
+void CloneVisitor::visit(ASTReturn* node) {
+    cloned = new ASTReturn(clone(node->returnValue), line(node));
+}
+
+
+void CloneVisitor::visit(ASTUnary* node) {
+    cloned = new ASTUnary(node->op, clone(node->expression), line(node));
+}
+
+
+void CloneVisitor::visit(ASTVariableDecl* node) {
+    ASTExpression* value = clone(node->value);
+
+    cloned = new ASTVariableDecl(copyIdentifier(node->identifier), node->type, value, line(node));
+}
+
+
+void CloneVisitor::visit(ASTWhile* node) {
+    ASTExpression* conditional = clone(node->conditional);
+    ASTBlock* block = clone(node->block);
+
+    cloned = new ASTWhile(conditional, block, line(node));
+}
@@ -0,0 +1,73 @@
+#ifndef CPS2000_ASSIGNMENT_CLONEVISITOR_H
+#define CPS2000_ASSIGNMENT_CLONEVISITOR_H
+
+#include <string>
+#include <map>
+#include "Visitor.h"
+#include "../AST/AST.h"
+
+using namespace std;
+
+
+/*
+ * Makes a deep copy of a syntax tree.
+ * Variables can be replaced by int constants while copying, this is used when unrolling loops.
+ * Optimisation annotations are not copied.
+ */
+class CloneVisitor : public Visitor {
+public:
+    CloneVisitor();
+    explicit CloneVisitor(map<string, int> constants);
+
+    void setLineOffset(int offset);
+
+    template <class T>
+    T* clone(T* node);
+
+    void visit(ASTProgram*) override;
+    void visit(ASTAssignment*) override;
+    void visit(ASTBinOp*) override;
+    void visit(ASTBlock*) override;
+    void visit(ASTFor*) override;
+    void visit(ASTFormalParam*) override;
+    void visit(ASTFunctionCall*) override;
+    void visit(ASTFunctionDecl*) override;
+    void visit(ASTIdentifier*) override;
+    void visit(ASTIf*) override;
+    void visit(ASTLiteralBool*) override;
+    void visit(ASTLiteralFloat*) override;
+    void visit(ASTLiteralInt*) override;
+    void visit(ASTLiteralString*) override;
+    void visit(ASTPrint*) override;
+    void visit(ASTReturn*) override;
+    void visit(ASTUnary*) override;
+    void visit(ASTVariableDecl*) override;
+    void visit(ASTWhile*) override;
+
+
+private:
+    map<string, int> constants; //Variables which are replaced by a constant
+    ASTNode* cloned;            //The copy of the last node visited
+    int lineOffset;             //Added to the line of every node copied
+
+    ASTIdentifier* copyIdentifier(ASTIdentifier* node);
+    int line(ASTNode* node);
+};
+
+
+/*
+ * Returns a copy of the given node, which can be null.
+ */
+template <class T>
+T* CloneVisitor::clone(T* node) {
+    if (node == nullptr) {
+        return nullptr;
+    }
+
+    node->accept(this);
+    return (T*) cloned;
+}
+
+
+
+#endif //CPS2000_ASSIGNMENT_CLONEVISITOR_H
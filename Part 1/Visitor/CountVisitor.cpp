@@ -0,0 +1,162 @@
+#include "CountVisitor.h"
+
+
+const char* const CountVisitor::kindNames[NODE_KINDS] = {
+        "Program", "Assignment", "BinOp", "Block", "For", "FormalParam", "FunctionCall", "FunctionDecl",
+        "Identifier", "If", "LiteralBool", "LiteralFloat", "LiteralInt", "LiteralString", "Print", "Return",
+        "Unary", "VariableDecl", "While"
+};
+
+
+CountVisitor::CountVisitor() {
+    for (long long& count : counts) {
+        count = 0;
+    }
+}
+
+
+/*
+ * The number of nodes of a kind, indexed in the same order as kindNames.
+ */
+long long CountVisitor::getCount(int kind) {
+    return counts[kind];
+}
+
+
+/*
+ * Visit functions count the node, then its children.
+ */
+
+void CountVisitor::visit(ASTProgram* node) {
+    counts[0]++;
+    for (ASTStatement* s : node->program) {
+        s->accept(this);
+    }
+}
+
+
+void CountVisitor::visit(ASTAssignment* node) {
+    counts[1]++;
+    node->identifier->accept(this);
+    node->value->accept(this);
+}
+
+
+void CountVisitor::visit(ASTBinOp* node) {
+    counts[2]++;
+    node->lExpression->accept(this);
+    node->rExpression->accept(this);
+}
+
+
+void CountVisitor::visit(ASTBlock* node) {
+    counts[3]++;
+    for (ASTStatement* s : node->block) {
+        s->accept(this);
+    }
+}
+
+
+void CountVisitor::visit(ASTFor* node) {
+    counts[4]++;
+    if (node->declaration != nullptr) {
+        node->declaration->accept(this);
+    }
+    node->conditional->accept(this);
+    if (node->assignment != nullptr) {
+        node->assignment->accept(this);
+    }
+    node->block->accept(this);
+}
+
+
+void CountVisitor::visit(ASTFormalParam* node) {
+    counts[5]++;
+    node->identifier->accept(this);
+}
+
+
+void CountVisitor::visit(ASTFunctionCall* node) {
+    counts[6]++;
+    node->identifier->accept(this);
+    for (ASTExpression* param : node->param) {
+        param->accept(this);
+    }
+}
+
+
+void CountVisitor::visit(ASTFunctionDecl* node) {
+    counts[7]++;
+    node->identifier->accept(this);
+    for (ASTFormalParam* param : node->parameters) {
+        param->accept(this);
+    }
+    node->block->accept(this);
+}
+
+
+void CountVisitor::visit(ASTIdentifier*) {
+    counts[8]++;
+}
+
+
+void CountVisitor::visit(ASTIf* node) {
+    counts[9]++;
+    node->conditional->accept(this);
+    node->ifBlock->accept(this);
+    if (node->elseBlock != nullptr) {
+        node->elseBlock->accept(this);
+    }
+}
+
+
+void CountVisitor::visit(ASTLiteralBool*) {
+    counts[10]++;
+}
+
+
+void CountVisitor::visit(ASTLiteralFloat*) {
+    counts[11]++;
+}
+
+
+void CountVisitor::visit(ASTLiteralInt*) {
+    counts[12]++;
+}
+
+
+void CountVisitor::visit(ASTLiteralString*) {
+    counts[13]++;
+}
+
+
+void CountVisitor::visit(ASTPrint* node) {
+    counts[14]++;
+    node->expression->accept(this);
+}
+
+
+void CountVisitor::visit(ASTReturn* node) {
+    counts[15]++;
+    node->returnValue->accept(this);
+}
+
+
+void CountVisitor::visit(ASTUnary* node) {
+    counts[16]++;
+    node->expression->accept(this);
+}
+
+
+void CountVisitor::visit(ASTVariableDecl* node) {
+    counts[17]++;
+    node->identifier->accept(this);
+    node->value->accept(this);
+}
+
+
+void CountVisitor::visit(ASTWhile* node) {
+    counts[18]++;
+    node->conditional->accept(this);
+    node->block->accept(this);
+}
@@ -0,0 +1,48 @@
+#ifndef CPS2000_ASSIGNMENT_COUNTVISITOR_H
+#define CPS2000_ASSIGNMENT_COUNTVISITOR_H
+
+#include "Visitor.h"
+#include "../AST/AST.h"
+
+#define NODE_KINDS 19
+
+
+/*
+ * Counts the nodes of each kind in a program.
+ * Only the tree built by the parser is counted, not any annotations added by the optimiser or interpreter.
+ */
+class CountVisitor : public Visitor {
+public:
+    CountVisitor();
+
+    static const char* const kindNames[NODE_KINDS];     //The class of each kind, without the AST prefix
+    long long getCount(int kind);
+
+    void visit(ASTProgram*) override;
+    void visit(ASTAssignment*) override;
+    void visit(ASTBinOp*) override;
+    void visit(ASTBlock*) override;
+    void visit(ASTFor*) override;
+    void visit(ASTFormalParam*) override;
+    void visit(ASTFunctionCall*) override;
+    void visit(ASTFunctionDecl*) override;
+    void visit(ASTIdentifier*) override;
+    void visit(ASTIf*) override;
+    void visit(ASTLiteralBool*) override;
+    void visit(ASTLiteralFloat*) override;
+    void visit(ASTLiteralInt*) override;
+    void visit(ASTLiteralString*) override;
+    void visit(ASTPrint*) override;
+    void visit(ASTReturn*) override;
+    void visit(ASTUnary*) override;
+    void visit(ASTVariableDecl*) override;
+    void visit(ASTWhile*) override;
+
+
+private:
+    long long counts[NODE_KINDS];   //In the same order as the visit functions
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_COUNTVISITOR_H
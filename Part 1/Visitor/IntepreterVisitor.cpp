@@ -4,7 +4,108 @@
 using namespace std;
 
 
-InterpreterVisitor::InterpreterVisitor() = default;
+InterpreterVisitor::InterpreterVisitor() {
+    this->returning = false;
+    this->jit = nullptr;
+    this->superinstructions = true;
+    this->retainGlobals = false;
+    this->dispatches = 0;
+    this->calls = 0;
+    this->profile = nullptr;
+    this->governor = nullptr;
+    this->output = &OutputSink::standardOutput();
+}
+
+InterpreterVisitor::InterpreterVisitor(JITVisitor* jit) {
+    this->returning = false;
+    this->jit = jit;
+    this->superinstructions = true;
+    this->retainGlobals = false;
+    this->dispatches = 0;
+    this->calls = 0;
+    this->profile = nullptr;
+    this->governor = nullptr;
+    this->output = &OutputSink::standardOutput();
+}
+
+
+/*
+ * Superinstructions are enabled by default, disabling them runs every node through its visit function.
+ */
+void InterpreterVisitor::setSuperinstructions(bool enabled) {
+    this->superinstructions = enabled;
+}
+
+
+/*
+ * Leaves the global scope of each program on the table, so the caller can keep its variables and functions
+ * for the next program run by this interpreter.
+ */
+void InterpreterVisitor::setRetainGlobals(bool enabled) {
+    this->retainGlobals = enabled;
+}
+
+
+/*
+ * Counts each loop iteration and function call against the governor's limits, if not null.
+ * Scripts are not limited by default.
+ */
+void InterpreterVisitor::setGovernor(Governor* governor) {
+    this->governor = governor;
+}
+
+
+/*
+ * Print statements write to the standard output by default.
+ */
+void InterpreterVisitor::setOutput(OutputSink* output) {
+    this->output = output;
+
+    if (jit != nullptr) {
+        jit->setOutput(output);
+    }
+}
+
+
+/*
+ * Counts the number of times each binary operation and assignment is run, if not null.
+ */
+void InterpreterVisitor::setProfile(map<ASTNode*, long long>* profile) {
+    this->profile = profile;
+}
+
+
+/*
+ * The number of visit functions run so far.
+ */
+long long InterpreterVisitor::getDispatches() {
+    return dispatches;
+}
+
+
+/*
+ * The number of function calls run so far, including calls to compiled functions.
+ */
+long long InterpreterVisitor::getCalls() {
+    return calls;
+}
+
+
+/*
+ * The symbol table of the program being run.
+ */
+SymbolTable* InterpreterVisitor::getTable() {
+    return &table;
+}
+
+
+/*
+ * True if a return statement outside of any function was run, which ends the program.
+ * Used when the program's statements are run one at a time rather than through visit(ASTProgram).
+ */
+bool InterpreterVisitor::isReturning() {
+    return returning;
+}
 
 
 /*
@@ -74,31 +175,474 @@ void InterpreterVisitor::convertReturnedType(VariableType type) {
 }
 
 
+/*
+ * Evaluates a relational operator on two values of the same type.
+ */
+template <class T>
+bool InterpreterVisitor::compare(Operator op, T lValue, T rValue) {
+    switch (op) {
+        case LESSTHAN:
+            return lValue < rValue;
+        case LESSTHANEQUAL:
+            return lValue <= rValue;
+        case GREATERTHAN:
+            return lValue > rValue;
+        case GREATERTHANEQUAL:
+            return lValue >= rValue;
+        case EQUALS:
+            return lValue == rValue;
+        case NOTEQUALS:
+            return lValue != rValue;
+        default:
+            throw runtime_error("Unknown Operator.");
+    }
+}
+
+
+/*
+ * Runs a for loop which the optimiser found to be of the form for (let i:int = a; i < n; i = i + c).
+ * The induction variable is kept in a native int rather than being re-evaluated through the
+ * condition and assignment expressions, and is written straight into its symbol on every iteration.
+ * Unrolled loops run a group of iterations each time the condition is checked.
+ */
+void InterpreterVisitor::runCountedLoop(ASTFor* node) {
+
+    CountedLoop* loop = node->counted;
+
+    //Enter a new scope
+    table.push();
+
+    //Declare the induction variable and initialise it as an int
+    string id = node->declaration->identifier->identifier;
+    table.declare(node->declaration);
+
+    node->declaration->value->accept(this);
+    convertReturnedType(INT);
+    int i = returnedInt;
+
+    table.assign(id, i);
+    auto counter = (ASTLiteralInt*) table.findSymbol(id)->second.value;
+
+
+    //Calculate the initial value of any reduced multiplications and how much they change by each iteration
+    for (DerivedInduction* derived : loop->derived) {
+        derived->factor->accept(this);
+        derived->active = (returnedType == INT);
+        derived->factorValue = returnedInt;
+        derived->value = (int) ((unsigned) i * (unsigned) returnedInt);
+        derived->step = (int) ((unsigned) loop->step * (unsigned) returnedInt);
+    }
+
+
+    //Evaluate the bound once if it cannot change
+    VariableType boundType = FLOAT;
+    int intBound = 0;
+    float floatBound = 0;
+
+    if (loop->invariantBound) {
+        loop->bound->accept(this);
+        if (returnedType != FLOAT) {
+            convertReturnedType(INT);
+        }
+
+        boundType = returnedType;
+        intBound = returnedInt;
+        floatBound = returnedFloat;
+    }
+
+
+    //Checks the loop condition for a value of the induction variable
+    auto inRange = [&](long long value) {
+        if (boundType == FLOAT) {
+            return (loop->op == LESSTHAN) ? ((float) value < floatBound) : ((float) value <= floatBound);
+        }
+        return (loop->op == LESSTHAN) ? (value < intBound) : (value <= intBound);
+    };
+
+
+    while (true) {
+
+        //Re-evaluate the bound if it may have changed
+        if (!loop->invariantBound) {
+            loop->bound->accept(this);
+            if (returnedType != FLOAT) {
+                convertReturnedType(INT);
+            }
+
+            boundType = returnedType;
+            intBound = returnedInt;
+            floatBound = returnedFloat;
+        }
+
+
+        //Check the condition
+        //The induction variable only increases in an unrolled loop, so if the condition holds
+        //for the last iteration in a group, it holds for every iteration in the group
+        int iterations = 1;
+        if (loop->unroll > 1 && inRange((long long) i + (long long) (loop->unroll - 1) * loop->step)) {
+            iterations = loop->unroll;
+        }
+        else if (!inRange(i)) {
+            break;
+        }
+
+
+        //Count the group of iterations against the limits
+        if (governor != nullptr) {
+            governor->tick(node->lineNum, iterations);
+        }
+
+        for (int k = 0; k < iterations; k++) {
+
+            //Evaluate the loop block
+            node->block->accept(this);
+
+            //Stop looping if a return statement was executed
+            if (returning) {
+                break;
+            }
+
+            //A function called by the block may have assigned the induction variable through the symbol table
+            bool reassigned = (counter->i != i);
+            if (reassigned) {
+                i = counter->i;
+
+                for (DerivedInduction* derived : loop->derived) {
+                    derived->value = (int) ((unsigned) i * (unsigned) derived->factorValue);
+                }
+            }
+
+
+            //Increment the induction variable and any products depending on it
+            i = (int) ((unsigned) i + (unsigned) loop->step);
+            counter->i = i;
+
+            for (DerivedInduction* derived : loop->derived) {
+                derived->value = (int) ((unsigned) derived->value + (unsigned) derived->step);
+            }
+
+
+            //The rest of the group may no longer satisfy the condition
+            if (reassigned) {
+                break;
+            }
+        }
+
+        if (returning) {
+            break;
+        }
+
+        //Move the rest of the loop to native code once it has run often enough
+        if (jit != nullptr && jit->transfer(node, &table)) {
+            break;
+        }
+    }
+
+
+    //Exit the scope
+    table.pop();
+
+}
+
+
+/*
+ * Carries out a binary operation, given the value of the left operand,
+ * on the right operand held in the returned value.
+ */
+void InterpreterVisitor::combine(Operator op, VariableType lType, bool lBool, float lFloat, int lInt,
+                                 const TeaString& lString) {
+
+    //Boolean operations only need the operands as bools
+    if (op == AND || op == OR) {
+        bool lValue = lBool;
+        if (lType == FLOAT) {
+            lValue = (bool) lFloat;
+        }
+        else if (lType == INT) {
+            lValue = (bool) lInt;
+        }
+
+        convertReturnedType(BOOL);
+
+        //Evaluate
+        if (op == AND) {
+            returnedBool = lValue && returnedBool;
+        } else {
+            returnedBool = lValue || returnedBool;
+        }
+
+        returnedType = BOOL;
+        return;
+    }
+
+
+    //Check which type the operation should be carried out in
+    VariableType rType = returnedType;
+
+    if (lType == STRING && rType == STRING) {
+        //Both operands are strings, the semantic visitor only allows concatenation and comparisons
+        if (op == PLUS) {
+            //The result shares the left operand's buffer, so s = s + piece only copies the piece
+            TeaString result = lString;
+            result.append(returnedString);
+            returnedString = result;
+            returnedType = STRING;
+        }
+        else {
+            int comparison = lString.compare(returnedString);
+            returnedBool = compare(op, comparison, 0);
+            returnedType = BOOL;
+        }
+    }
+
+    else if (lType == FLOAT || rType == FLOAT) {
+        //At least one operand is a float, widen both to floats
+        if (lType == INT) {
+            lFloat = (float) lInt;
+        }
+        else if (lType == BOOL) {
+            lFloat = (float) lBool;
+        }
+        convertReturnedType(FLOAT);
+
+        switch (op) {
+            case PLUS:
+                returnedFloat = lFloat + returnedFloat;
+                break;
+            case MINUS:
+                returnedFloat = lFloat - returnedFloat;
+                break;
+            case MULT:
+                returnedFloat = lFloat * returnedFloat;
+                break;
+            case DIVIDE:
+                returnedFloat = lFloat / returnedFloat;
+                break;
+            default:
+                returnedBool = compare(op, lFloat, returnedFloat);
+                returnedType = BOOL;
+                return;
+        }
+
+        returnedType = FLOAT;
+    }
+
+    else {
+        //Both operands are ints (or bools), use integer arithmetic
+        //Overflow wraps around, so the arithmetic is carried out on unsigned values
+        if (lType == BOOL) {
+            lInt = (int) lBool;
+        }
+        convertReturnedType(INT);
+
+        switch (op) {
+            case PLUS:
+                returnedInt = (int) ((unsigned) lInt + (unsigned) returnedInt);
+                break;
+            case MINUS:
+                returnedInt = (int) ((unsigned) lInt - (unsigned) returnedInt);
+                break;
+            case MULT:
+                returnedInt = (int) ((unsigned) lInt * (unsigned) returnedInt);
+                break;
+            case DIVIDE:
+                //Division always produces a float, calculated in double precision so large ints are not rounded first
+                returnedFloat = (float) ((double) lInt / (double) returnedInt);
+                returnedType = FLOAT;
+                return;
+            default:
+                returnedBool = compare(op, lInt, returnedInt);
+                returnedType = BOOL;
+                return;
+        }
+
+        returnedType = INT;
+    }
+
+}
+
+
+/*
+ * Chooses the superinstruction which runs a binary operation, if one was compiled in for its operands.
+ */
+Superinstruction InterpreterVisitor::select(ASTBinOp* node) {
+
+#define SUPERINSTRUCTION_BinOp(Left, Right) \
+    if (dynamic_cast<Left*>(node->lExpression) != nullptr && dynamic_cast<Right*>(node->rExpression) != nullptr) { \
+        return BinOp_##Left##_##Right; \
+    }
+#define SUPERINSTRUCTION_Assignment(Left, Right)
+#define SUPERINSTRUCTION(Node, Left, Right) SUPERINSTRUCTION_##Node(Left, Right)
+#include "Superinstructions.inc"
+#undef SUPERINSTRUCTION
+#undef SUPERINSTRUCTION_Assignment
+#undef SUPERINSTRUCTION_BinOp
+
+    return NOT_FUSED;
+}
+
+
+/*
+ * Chooses the superinstruction which runs an assignment and the binary operation it assigns, if one was compiled in.
+ * Multiplications reduced by the optimiser are left to the binary operation.
+ */
+Superinstruction InterpreterVisitor::select(ASTAssignment* node) {
+
+    auto value = dynamic_cast<ASTBinOp*>(node->value);
+    if (value == nullptr || value->induction != nullptr) {
+        return NOT_FUSED;
+    }
+
+#define SUPERINSTRUCTION_BinOp(Left, Right)
+#define SUPERINSTRUCTION_Assignment(Left, Right) \
+    if (dynamic_cast<Left*>(value->lExpression) != nullptr && dynamic_cast<Right*>(value->rExpression) != nullptr) { \
+        return Assignment_##Left##_##Right; \
+    }
+#define SUPERINSTRUCTION(Node, Left, Right) SUPERINSTRUCTION_##Node(Left, Right)
+#include "Superinstructions.inc"
+#undef SUPERINSTRUCTION
+#undef SUPERINSTRUCTION_Assignment
+#undef SUPERINSTRUCTION_BinOp
+
+    return NOT_FUSED;
+}
+
+
+/*
+ * Evaluates the operands of a superinstruction without dispatching to their visit functions.
+ */
+void InterpreterVisitor::operand(ASTIdentifier* node) {
+    Symbol& symbol = table.findSymbol(node->identifier)->second;
+
+    switch (symbol.type) {
+        case BOOL:
+            returnedBool = ((ASTLiteralBool*) symbol.value)->b;
+            break;
+        case FLOAT:
+            returnedFloat = ((ASTLiteralFloat*) symbol.value)->f;
+            break;
+        case INT:
+            returnedInt = ((ASTLiteralInt*) symbol.value)->i;
+            break;
+        default:
+            returnedString = ((ASTLiteralString*) symbol.value)->s;
+            break;
+    }
+
+    returnedType = symbol.type;
+}
+
+void InterpreterVisitor::operand(ASTLiteralBool* node) {
+    returnedBool = node->b;
+    returnedType = BOOL;
+}
+
+void InterpreterVisitor::operand(ASTLiteralFloat* node) {
+    returnedFloat = node->f;
+    returnedType = FLOAT;
+}
+
+void InterpreterVisitor::operand(ASTLiteralInt* node) {
+    returnedInt = node->i;
+    returnedType = INT;
+}
+
+void InterpreterVisitor::operand(ASTLiteralString* node) {
+    returnedString = node->s;
+    returnedType = STRING;
+}
+
+
+/*
+ * Runs a binary operation whose operands are known to be of the classes Left and Right.
+ */
+template <class Left, class Right>
+void InterpreterVisitor::fusedBinOp(ASTBinOp* node) {
+
+    operand(static_cast<Left*>(node->lExpression));
+    VariableType lType = returnedType;
+    bool lBool = returnedBool;
+    float lFloat = returnedFloat;
+    int lInt = returnedInt;
+    TeaString lString;
+    if (lType == STRING) {
+        lString = returnedString;
+    }
+
+    operand(static_cast<Right*>(node->rExpression));
+    combine(node->op, lType, lBool, lFloat, lInt, lString);
+}
+
+
 /*
  * Visit Functions
  */
 
 
 void InterpreterVisitor::visit(ASTProgram* node) {
+    dispatches++;
 
     //Enter a new scope
     table.push();
+    returning = false;
 
-    //Execute each statement in the list
+    //Execute each statement in the list, a return statement ends the program
     for(ASTStatement* statement : node->program) {
-        statement->accept(this);
+        try {
+            statement->accept(this);
+        }
+        catch (ByteLimitError& e) {
+            //Name the innermost statement which went over the memory limit
+            throw runtime_error("Line " + to_string(statement->lineNum) + ": " + e.what());
+        }
+
+        if (returning) {
+            break;
+        }
     }
 
-    //Exit the scope
-    table.pop();
+    //Exit the scope, unless the caller keeps it
+    if (!retainGlobals) {
+        table.pop();
+    }
 
 }
 
 
 void InterpreterVisitor::visit(ASTAssignment* node) {
+    dispatches++;
 
-    //Evaluate the expression
-    node->value->accept(this);
+    if (profile != nullptr) {
+        (*profile)[node]++;
+    }
+
+    //Evaluate the expression, in one handler with its operands if a superinstruction was compiled in for them
+    bool fused = false;
+    if (superinstructions) {
+        if (node->fused == UNSELECTED) {
+            node->fused = select(node);
+        }
+
+        switch (node->fused) {
+#define SUPERINSTRUCTION_BinOp(Left, Right)
+#define SUPERINSTRUCTION_Assignment(Left, Right) \
+            case Assignment_##Left##_##Right: \
+                fusedBinOp<Left, Right>((ASTBinOp*) node->value); \
+                fused = true; \
+                break;
+#define SUPERINSTRUCTION(Node, Left, Right) SUPERINSTRUCTION_##Node(Left, Right)
+#include "Superinstructions.inc"
+#undef SUPERINSTRUCTION
+#undef SUPERINSTRUCTION_Assignment
+#undef SUPERINSTRUCTION_BinOp
+            default:
+                break;
+        }
+    }
+
+    if (!fused) {
+        node->value->accept(this);
+    }
 
     //Check the variable's type and convert the returned value accordingly
     string id = node->identifier->identifier;
@@ -133,104 +677,79 @@ void InterpreterVisitor::visit(ASTAssignment* node) {
 
 
 void InterpreterVisitor::visit(ASTBinOp* node) {
+    dispatches++;
 
-    //Check if this is arithmetic or boolean
-    switch(node->op) {
-        case PLUS:
-        case MINUS:
-        case MULT:
-        case DIVIDE:
-        case GREATERTHAN:
-        case GREATERTHANEQUAL:
-        case LESSTHAN:
-        case LESSTHANEQUAL:
-        case EQUALS:
-        case NOTEQUALS:
-        {
-            //Read the operands as floats
-            node->lExpression->accept(this);
-            convertReturnedType(FLOAT);
-            float lValue = returnedFloat;
-
-            node->rExpression->accept(this);
-            convertReturnedType(FLOAT);
-            float rValue = returnedFloat;
-
-            //Evaluate
-            if (node->op == PLUS) {
-                returnedFloat = lValue + rValue;
-            } else if (node->op == MINUS) {
-                returnedFloat = lValue - rValue;
-            } else if (node->op == MULT) {
-                returnedFloat = lValue * rValue;
-            } else if (node->op == DIVIDE) {
-                returnedFloat = lValue / rValue;
-            }
-            else if (node->op == GREATERTHAN) {
-                returnedFloat = lValue > rValue;
-            }
-            else if (node->op == GREATERTHANEQUAL) {
-                returnedFloat = lValue >= rValue;
-            }
-            else if (node->op == LESSTHAN) {
-                returnedFloat = lValue < rValue;
-            }
-            else if (node->op == LESSTHANEQUAL) {
-                returnedFloat = lValue <= rValue;
-            }
-            else if (node->op == EQUALS) {
-                returnedFloat = lValue == rValue;
-            }
-            else if (node->op == NOTEQUALS) {
-                returnedFloat = lValue != rValue;
-            }
-
-            returnedType = FLOAT;
-        }
-            break;
-
-
-        case AND:
-        case OR:
-        {
-            //Read the operands as floats
-            node->lExpression->accept(this);
-            convertReturnedType(BOOL);
-            bool lValue = returnedBool;
+    if (profile != nullptr) {
+        (*profile)[node]++;
+    }
 
-            node->rExpression->accept(this);
-            convertReturnedType(FLOAT);
-            bool rValue = returnedFloat;
+    //Multiplications reduced by the optimiser are kept up to date by the enclosing loop
+    if (node->induction != nullptr && node->induction->active) {
+        returnedInt = node->induction->value;
+        returnedType = INT;
+        return;
+    }
 
-            //Evaluate
-            if (node->op == AND) {
-                returnedBool = lValue && rValue;
-            } else if (node->op == OR) {
-                returnedBool = lValue || rValue;
-            }
 
-            returnedType = BOOL;
+    //Run the operation and its operands in one handler if a superinstruction was compiled in for them
+    if (superinstructions) {
+        if (node->fused == UNSELECTED) {
+            node->fused = select(node);
         }
 
-            break;
-
+        switch (node->fused) {
+#define SUPERINSTRUCTION_BinOp(Left, Right) \
+            case BinOp_##Left##_##Right: \
+                fusedBinOp<Left, Right>(node); \
+                return;
+#define SUPERINSTRUCTION_Assignment(Left, Right)
+#define SUPERINSTRUCTION(Node, Left, Right) SUPERINSTRUCTION_##Node(Left, Right)
+#include "Superinstructions.inc"
+#undef SUPERINSTRUCTION
+#undef SUPERINSTRUCTION_Assignment
+#undef SUPERINSTRUCTION_BinOp
+            default:
+                break;
+        }
+    }
 
-        default:
-            throw runtime_error("Line " + to_string(node->lineNum) + ": Unknown Operator.");
 
+    //Evaluate the left operand and store its value, since evaluating the right operand will overwrite it
+    node->lExpression->accept(this);
+    VariableType lType = returnedType;
+    bool lBool = returnedBool;
+    float lFloat = returnedFloat;
+    int lInt = returnedInt;
+    TeaString lString;
+    if (lType == STRING) {
+        lString = returnedString;
     }
 
+    node->rExpression->accept(this);
+    combine(node->op, lType, lBool, lFloat, lInt, lString);
+
 }
 
 
 void InterpreterVisitor::visit(ASTBlock* node) {
+    dispatches++;
 
     //Enter a new scope
     table.push();
 
-    //Execute each statement in the list
+    //Execute each statement in the list, until a return statement is executed
     for(ASTStatement* statement : node->block) {
-        statement->accept(this);
+        try {
+            statement->accept(this);
+        }
+        catch (ByteLimitError& e) {
+            //Name the innermost statement which went over the memory limit
+            throw runtime_error("Line " + to_string(statement->lineNum) + ": " + e.what());
+        }
+
+        if (returning) {
+            break;
+        }
     }
 
     //Exit the scope
@@ -240,6 +759,13 @@ void InterpreterVisitor::visit(ASTBlock* node) {
 
 
 void InterpreterVisitor::visit(ASTFor* node) {
+    dispatches++;
+
+    //Counted loops found by the optimiser can be run with a native counter
+    if (node->counted != nullptr) {
+        runCountedLoop(node);
+        return;
+    }
 
     //Enter a new scope
     table.push();
@@ -257,11 +783,28 @@ void InterpreterVisitor::visit(ASTFor* node) {
     //Loop while the conditional returns true
     while (returnedBool) {
 
+        //Count the iteration against the limits
+        if (governor != nullptr) {
+            governor->tick(node->lineNum);
+        }
+
         //Evaluate the loop block
         node->block->accept(this);
 
+        //Stop looping if a return statement was executed
+        if (returning) {
+            break;
+        }
+
         //Evaluate the increment/assignment
-        node->assignment->accept(this);
+        if (node->assignment != nullptr) {
+            node->assignment->accept(this);
+        }
+
+        //Move the rest of the loop to native code once it has run often enough
+        if (jit != nullptr && jit->transfer(node, &table)) {
+            break;
+        }
 
         //Re-evaluate the conditional
         node->conditional->accept(this);
@@ -276,35 +819,30 @@ void InterpreterVisitor::visit(ASTFor* node) {
 
 
 void InterpreterVisitor::visit(ASTFormalParam* node) {
+    dispatches++;
     //No need to do anything, formal param should not be visited
 }
 
 
 void InterpreterVisitor::visit(ASTFunctionCall* node) {
+    dispatches++;
+    calls++;
 
     //Evaluate each parameter and check its returned type
     vector<VariableType> types;
-    vector<ASTLiteral*> values;
+    vector<Argument> values;
+    types.reserve(node->param.size());
+    values.reserve(node->param.size());
+
     for (ASTExpression* param : node->param) {
         param->accept(this);
 
         //Store the type
         types.push_back(returnedType);
 
-        //Store the correct value
-        if (returnedType == BOOL) {
-            values.push_back(new ASTLiteralBool(returnedBool, 0));
-        }
-        else if (returnedType == FLOAT) {
-            values.push_back(new ASTLiteralFloat(returnedFloat, 0));
-        }
-        else if (returnedType == INT) {
-            values.push_back(new ASTLiteralInt(returnedInt, 0));
-        }
-        else if (returnedType == STRING) {
-            values.push_back(new ASTLiteralString(returnedString, 0));
-        }
-
+        //Store the value, strings are shared rather than copied
+        values.push_back(Argument{returnedType, returnedBool, returnedFloat, returnedInt,
+                                  (returnedType == STRING) ? returnedString : TeaString()});
     }
 
     //Find the declaration of the function being called
@@ -312,6 +850,30 @@ void InterpreterVisitor::visit(ASTFunctionCall* node) {
     ASTFunctionDecl* func = table.getFunction(id, &types);
 
 
+    //Run the function's native code instead, if it has been compiled
+    if (jit != nullptr) {
+        JITFunction native = jit->getCompiled(func, &table);
+
+        if (native != nullptr) {
+            vector<long long> args;
+            for (const Argument& value : values) {
+                args.push_back(JITVisitor::toArgument(value.type, value.b, value.f, value.i));
+            }
+
+            long long result = native(args.data());
+
+            returnedType = func->returnType;
+            JITVisitor::fromResult(result, returnedType, &returnedBool, &returnedFloat, &returnedInt);
+            return;
+        }
+    }
+
+
+    //Count the call against the limits
+    if (governor != nullptr) {
+        governor->enter(node->lineNum);
+    }
+
     //Enter a new scope
     table.push();
 
@@ -322,29 +884,25 @@ void InterpreterVisitor::visit(ASTFunctionCall* node) {
 
         //Assign its value
         if (formalParam->type == BOOL) {
-            ASTLiteralBool* literal = (ASTLiteralBool*) values[i];
-            table.assign(formalParam->identifier->identifier, literal->b);
-
+            table.assign(formalParam->identifier->identifier, values[i].b);
         }
         else if (formalParam->type == FLOAT) {
-            ASTLiteralFloat* literal = (ASTLiteralFloat*) values[i];
-            table.assign(formalParam->identifier->identifier, literal->f);
+            table.assign(formalParam->identifier->identifier, values[i].f);
         }
         else if (formalParam->type == INT) {
-            ASTLiteralInt* literal = (ASTLiteralInt*) values[i];
-            table.assign(formalParam->identifier->identifier, literal->i);
+            table.assign(formalParam->identifier->identifier, values[i].i);
         }
         else if (formalParam->type == STRING) {
-            ASTLiteralString* literal = (ASTLiteralString*) values[i];
-            table.assign(formalParam->identifier->identifier, literal->s);
+            table.assign(formalParam->identifier->identifier, values[i].s);
         }
 
         i++;
     }
 
 
-    // Execute the function
+    // Execute the function, until it returns
     func->block->accept(this);
+    returning = false;
 
 
     //Store the returned value in the correct type
@@ -354,22 +912,29 @@ void InterpreterVisitor::visit(ASTFunctionCall* node) {
     //Exit the scope
     table.pop();
 
+    if (governor != nullptr) {
+        governor->leave();
+    }
+
 }
 
 
 void InterpreterVisitor::visit(ASTFunctionDecl* node) {
+    dispatches++;
     //Just declare the function in the symbol table
     table.declare(node);
 }
 
 
 void InterpreterVisitor::visit(ASTIdentifier* node) {
+    dispatches++;
     //Get the literal node stored as the symbol and visit it
     table.findSymbol(node->identifier)->second.value->accept(this);
 }
 
 
 void InterpreterVisitor::visit(ASTIf* node) {
+    dispatches++;
     //Enter a new scope
     table.push();
 
@@ -396,6 +961,7 @@ void InterpreterVisitor::visit(ASTIf* node) {
 
 
 void InterpreterVisitor::visit(ASTLiteralBool* node) {
+    dispatches++;
     //Just set the value
     returnedBool = node->b;
     returnedType = BOOL;
@@ -403,6 +969,7 @@ void InterpreterVisitor::visit(ASTLiteralBool* node) {
 
 
 void InterpreterVisitor::visit(ASTLiteralFloat* node) {
+    dispatches++;
     //Just set the value
     returnedFloat = node->f;
     returnedType = FLOAT;
@@ -410,6 +977,7 @@ void InterpreterVisitor::visit(ASTLiteralFloat* node) {
 
 
 void InterpreterVisitor::visit(ASTLiteralInt* node) {
+    dispatches++;
     //Just set the value
     returnedInt = node->i;
     returnedType = INT;
@@ -417,6 +985,7 @@ void InterpreterVisitor::visit(ASTLiteralInt* node) {
 
 
 void InterpreterVisitor::visit(ASTLiteralString* node) {
+    dispatches++;
     //Just set the value
     returnedString = node->s;
     returnedType = STRING;
@@ -424,39 +993,54 @@ void InterpreterVisitor::visit(ASTLiteralString* node) {
 
 
 void InterpreterVisitor::visit(ASTPrint* node) {
+    dispatches++;
     //Evaluate the expression
     node->expression->accept(this);
 
     //Print the correct value
     if (returnedType == BOOL) {
-        cout << (returnedBool ? "true":"false") << endl;
+        output->write(returnedBool);
     }
     else if (returnedType == FLOAT) {
-        cout << returnedFloat << endl;
+        output->write(returnedFloat);
     }
     else if (returnedType == INT) {
-        cout << returnedInt << endl;
+        output->write(returnedInt);
     }
     else if (returnedType == STRING) {
-        cout << returnedString << endl;
+        output->write(returnedString);
     }
+    output->endLine();
 
 }
 
 
 void InterpreterVisitor::visit(ASTReturn* node) {
+    dispatches++;
     //Evaluate the returned expression
     node->returnValue->accept(this);
+
+    //Stop executing the function
+    returning = true;
 }
 
 
 void InterpreterVisitor::visit(ASTUnary* node) {
+    dispatches++;
+
+    //Evaluate the expression
+    node->expression->accept(this);
 
     //Check the operator
     if (node->op == MINUS) {
-        //Convert to a float and then carry out the operation
-        convertReturnedType(FLOAT);
-        returnedFloat = -returnedFloat;
+        //Negate ints directly, anything else is carried out as a float
+        if (returnedType == INT) {
+            returnedInt = (int) (0u - (unsigned) returnedInt);
+        }
+        else {
+            convertReturnedType(FLOAT);
+            returnedFloat = -returnedFloat;
+        }
     }
     else if (node-> op == NOT) {
         //Convert to a bool and then carry out the operation
@@ -471,11 +1055,13 @@ void InterpreterVisitor::visit(ASTUnary* node) {
 
 
 void InterpreterVisitor::visit(ASTVariableDecl* node) {
+    dispatches++;
     //First declare the variable
     table.declare(node);
 
-    //Then initialise it using an assignment
+    //Then initialise it using an assignment, converting the value to the variable's type
     node->value->accept(this);
+    convertReturnedType(node->type);
 
     //Assign the correct value
     string id = node->identifier->identifier;
@@ -495,6 +1081,7 @@ void InterpreterVisitor::visit(ASTVariableDecl* node) {
 
 
 void InterpreterVisitor::visit(ASTWhile* node) {
+    dispatches++;
 
     //Enter a new scope
     table.push();
@@ -506,9 +1093,24 @@ void InterpreterVisitor::visit(ASTWhile* node) {
     //Loop while the conditional returns true
     while (returnedBool) {
 
+        //Count the iteration against the limits
+        if (governor != nullptr) {
+            governor->tick(node->lineNum);
+        }
+
         //Evaluate the loop block
         node->block->accept(this);
 
+        //Stop looping if a return statement was executed
+        if (returning) {
+            break;
+        }
+
+        //Move the rest of the loop to native code once it has run often enough
+        if (jit != nullptr && jit->transfer(node, &table)) {
+            break;
+        }
+
         //Re-evaluate the conditional
         node->conditional->accept(this);
         convertReturnedType(BOOL);
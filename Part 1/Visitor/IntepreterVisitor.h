@@ -2,16 +2,44 @@
 #define CPS2000_ASSIGNMENT_INTEPRETERVISITOR_H
 
 
+#include <map>
 #include <string>
 #include "Visitor.h"
+#include "JITVisitor.h"
+#include "Superinstructions.h"
+#include "../Runtime/Governor.h"
+#include "../Runtime/OutputSink.h"
 #include "../SymbolTable/SymbolTable.h"
 
 using namespace std;
 
 
+/*
+ * The value of an argument to a function call, held until the function's scope is entered.
+ */
+struct Argument {
+    VariableType type;
+    bool b;
+    float f;
+    int i;
+    TeaString s;
+};
+
+
 class InterpreterVisitor : public Visitor {
 public:
     InterpreterVisitor();
+    explicit InterpreterVisitor(JITVisitor* jit);
+
+    void setSuperinstructions(bool enabled);
+    void setRetainGlobals(bool enabled);
+    void setGovernor(Governor* governor);
+    void setOutput(OutputSink* output);
+    void setProfile(map<ASTNode*, long long>* profile);
+    long long getDispatches();
+    long long getCalls();
+    SymbolTable* getTable();
+    bool isReturning();
 
     void visit(ASTProgram*) override;
     void visit(ASTAssignment*) override;
@@ -36,6 +64,20 @@ public:
 
 private:
     void convertReturnedType(VariableType type);
+    template <class T>
+    bool compare(Operator op, T lValue, T rValue);
+    void runCountedLoop(ASTFor* node);
+    void combine(Operator op, VariableType lType, bool lBool, float lFloat, int lInt, const TeaString& lString);
+
+    Superinstruction select(ASTBinOp* node);
+    Superinstruction select(ASTAssignment* node);
+    template <class Left, class Right>
+    void fusedBinOp(ASTBinOp* node);
+    void operand(ASTIdentifier* node);
+    void operand(ASTLiteralBool* node);
+    void operand(ASTLiteralFloat* node);
+    void operand(ASTLiteralInt* node);
+    void operand(ASTLiteralString* node);
 
     SymbolTable table;          //The stack of symbol tables, each table in the stack corresponds to a scope
 
@@ -43,12 +85,30 @@ private:
     bool returnedBool;
     float returnedFloat;
     int returnedInt;
-    string returnedString;
+    TeaString returnedString;
 
     //Track the type of the last returned value
     //Used to determine which return value to use
     VariableType returnedType;
 
+    //True while a return statement is leaving a function
+    bool returning;
+
+    //Compiles frequently called functions, null if functions are always interpreted
+    JITVisitor* jit;
+
+    //Stops the script if it goes over its limits, null if it is not limited
+    Governor* governor;
+
+    //Receives the output of print statements
+    OutputSink* output;
+
+    bool superinstructions;                 //True if nodes can be run by the superinstructions compiled in
+    bool retainGlobals;                     //True if the program's global scope is left on the table once it ends
+    long long dispatches;                   //Number of visit functions run
+    long long calls;                        //Number of functions called
+    map<ASTNode*, long long>* profile;      //Number of times each binary operation and assignment was run
+
 };
 
 
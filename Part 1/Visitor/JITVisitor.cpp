@@ -0,0 +1,1128 @@
+#include <cstring>
+#include <iostream>
+#include "JITVisitor.h"
+
+using namespace std;
+
+
+/*
+ * Called by compiled code to print a value, in the same format as the interpreter.
+ */
+static void printBool(OutputSink* output, int b) {
+    output->write(b != 0);
+    output->endLine();
+}
+
+static void printFloat(OutputSink* output, float f) {
+    output->write(f);
+    output->endLine();
+}
+
+static void printInt(OutputSink* output, int i) {
+    output->write(i);
+    output->endLine();
+}
+
+
+JITVisitor::JITVisitor() {
+    this->threshold = DEFAULT_JIT_THRESHOLD;
+    this->loopThreshold = DEFAULT_OSR_THRESHOLD;
+    this->table = nullptr;
+    this->output = &OutputSink::standardOutput();
+    this->returnedType = INCOMPATIBLE;
+    this->start = chrono::steady_clock::now();
+}
+
+JITVisitor::JITVisitor(int threshold, int loopThreshold) {
+    this->threshold = threshold;
+    this->loopThreshold = loopThreshold;
+    this->table = nullptr;
+    this->output = &OutputSink::standardOutput();
+    this->returnedType = INCOMPATIBLE;
+    this->start = chrono::steady_clock::now();
+}
+
+JITVisitor::~JITVisitor() {
+    //The code can no longer be called once the interpreter using this JIT is done
+    for (auto& mapping : mappings) {
+        Assembler::release(mapping.first, mapping.second);
+    }
+}
+
+
+/*
+ * Sets where compiled print statements write to, which should be the interpreter's output.
+ * Only affects code compiled afterwards.
+ */
+void JITVisitor::setOutput(OutputSink* output) {
+    this->output = output;
+}
+
+
+/*
+ * Records a call to a function made by the interpreter.
+ * Returns the function's native code, compiling it if it has now been called often enough,
+ * or null if the interpreter should run it.
+ */
+JITFunction JITVisitor::getCompiled(ASTFunctionDecl* func, SymbolTable* table) {
+
+    //Check if we already tried to compile the function
+    auto found = compiled.find(func);
+    if (found != compiled.end()) {
+        return found->second;
+    }
+
+    //Keep interpreting it until it is called often enough
+    if (++calls[func] < threshold) {
+        return nullptr;
+    }
+
+    this->table = table;
+    return compile(func);
+}
+
+
+/*
+ * Called by the interpreter on each back edge of a loop, after the loop's block (and increment) have run.
+ * Once the loop has run often enough it is compiled, and the rest of the loop is run by its native code.
+ * The variables it uses are copied out of the symbol table and written back when it exits.
+ * Returns true if the loop was completed by its native code, in which case the interpreter must leave it.
+ */
+bool JITVisitor::transfer(ASTStatement* loop, SymbolTable* table) {
+
+    JITLoop& info = loops[loop];
+
+    //Keep interpreting the loop until it has run often enough
+    if (info.code == nullptr) {
+        if (info.attempted || ++info.backEdges < loopThreshold) {
+            return false;
+        }
+
+        this->table = table;
+        compileLoop(loop, info);
+
+        if (info.code == nullptr) {
+            return false;
+        }
+    }
+
+
+    //The loop may be entered from a different scope, where its variables have other types
+    vector<long long> args;
+    for (JITCapture& capture : info.captures) {
+        if (!table->isDeclared(capture.id) || table->getType(capture.id) != capture.variable.type) {
+            return false;
+        }
+
+        args.push_back(toArgument(table->findSymbol(capture.id)->second.value));
+    }
+
+
+    //Run the rest of the loop, then write back the variables it used
+    info.code(args.data());
+    info.entries++;
+
+    for (size_t i = 0; i < info.captures.size(); i++) {
+        bool b;
+        float f;
+        int n;
+        fromResult(args[i], info.captures[i].variable.type, &b, &f, &n);
+
+        switch (info.captures[i].variable.type) {
+            case BOOL:
+                table->assign(info.captures[i].id, b);
+                break;
+            case FLOAT:
+                table->assign(info.captures[i].id, f);
+                break;
+            default:
+                table->assign(info.captures[i].id, n);
+                break;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Prints every function and loop which was compiled, and when.
+ */
+void JITVisitor::printStatistics(ostream& out) {
+
+    out << "Tiering statistics: " << promotions.size() << " promotions" << endl;
+
+    for (JITPromotion& promotion : promotions) {
+        out << "  " << promotion.description << " (line " << promotion.lineNum << ") ";
+
+        if (!promotion.compiled) {
+            out << "could not be compiled after " << promotion.count << " interpreted runs" << endl;
+            continue;
+        }
+
+        out << "compiled after " << promotion.count << " interpreted runs at "
+            << promotion.milliseconds << " ms";
+
+        if (promotion.loop != nullptr) {
+            out << ", entered " << loops[promotion.loop].entries << " times";
+        }
+        out << endl;
+    }
+}
+
+
+/*
+ * Records that a function or loop was compiled.
+ */
+void JITVisitor::promoted(const string& description, int lineNum, int count, bool compiled, ASTStatement* loop) {
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    promotions.push_back(JITPromotion{description, lineNum, count, elapsed.count(), compiled, loop});
+}
+
+
+/*
+ * Stores a value passed to a compiled function in its argument slot.
+ */
+long long JITVisitor::toArgument(ASTLiteral* value) {
+
+    auto literalBool = dynamic_cast<ASTLiteralBool*>(value);
+    if (literalBool != nullptr) {
+        return literalBool->b ? 1 : 0;
+    }
+
+    auto literalInt = dynamic_cast<ASTLiteralInt*>(value);
+    if (literalInt != nullptr) {
+        return (unsigned) literalInt->i;
+    }
+
+    auto literalFloat = dynamic_cast<ASTLiteralFloat*>(value);
+    if (literalFloat != nullptr) {
+        uint32_t bits;
+        memcpy(&bits, &literalFloat->f, sizeof(bits));
+        return bits;
+    }
+
+    throw runtime_error("Only bool, float and int values can be passed to compiled code.");
+}
+
+long long JITVisitor::toArgument(VariableType type, bool b, float f, int i) {
+    uint32_t bits;
+
+    switch (type) {
+        case BOOL:
+            return b ? 1 : 0;
+        case FLOAT:
+            memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        case INT:
+            return (unsigned) i;
+        default:
+            throw runtime_error("Only bool, float and int values can be passed to compiled code.");
+    }
+}
+
+
+/*
+ * Reads the value returned by a compiled function into the variable for its type.
+ */
+void JITVisitor::fromResult(long long result, VariableType type, bool* b, float* f, int* i) {
+    uint32_t bits = (uint32_t) result;
+
+    switch (type) {
+        case BOOL:
+            *b = (bits != 0);
+            break;
+        case FLOAT:
+            memcpy(f, &bits, sizeof(bits));
+            break;
+        case INT:
+            *i = (int) bits;
+            break;
+        default:
+            throw runtime_error("Only bool, float and int values can be returned by compiled code.");
+    }
+}
+
+
+/*
+ * Makes the code of the function or loop being compiled executable, remembering its memory so it can be unmapped.
+ */
+void* JITVisitor::finalise() {
+    void* memory = state.assembler.finalise();
+    mappings.emplace_back(memory, state.assembler.position());
+    return memory;
+}
+
+
+/*
+ * Compiles a function to native code, or returns null if it uses anything which cannot be compiled.
+ * The result is remembered, so a function is never compiled twice.
+ */
+JITFunction JITVisitor::compile(ASTFunctionDecl* func) {
+
+    //This may be a function called by the function currently being compiled
+    JITFunctionState saved = state;
+    state = JITFunctionState();
+    state.returnType = func->returnType;
+    state.region = false;
+    state.slots = 0;
+    state.maxSlots = 0;
+
+    JITFunction result;
+
+    try {
+#if !defined(__x86_64__)
+        throw runtime_error("Native code can only be generated for x86-64.");
+#endif
+
+        if (func->returnType == STRING) {
+            throw runtime_error("Line " + to_string(func->lineNum) + ": Strings cannot be compiled.");
+        }
+
+        Assembler& a = state.assembler;
+
+        //push rbp; mov rbp, rsp; sub rsp, frame size
+        a.emit({0x55, 0x48, 0x89, 0xE5, 0x48, 0x81, 0xEC});
+        state.frameSize = a.position();
+        a.emit32(0);
+
+
+        //Copy each argument into the frame
+        pushScope();
+
+        int i = 0;
+        for (ASTFormalParam* param : func->parameters) {
+            if (param->type == STRING) {
+                throw runtime_error("Line " + to_string(param->lineNum) + ": Strings cannot be compiled.");
+            }
+
+            JITVariable variable = {offsetOf(allocate()), param->type};
+            state.scopes.back()[param->identifier->identifier] = variable;
+
+            //mov rax, [rdi + 8i]; mov [rbp + offset], rax
+            a.emit({0x48, 0x8B, 0x87});
+            a.emit32(8 * i);
+            a.emit({0x48, 0x89, 0x85});
+            a.emit32(variable.offset);
+
+            i++;
+        }
+
+
+        //Compile the body, which may reach its end without a return statement
+        func->block->accept(this);
+        popScope();
+
+        //A function which falls off the end returns 0, false or 0.0, like the interpreter, xor eax, eax
+        a.emit({0x31, 0xC0});
+
+        //Every return statement jumps to the epilogue, leave; ret
+        for (size_t jump : state.returns) {
+            a.bind(jump);
+        }
+        a.emit({0xC9, 0xC3});
+
+
+        //The stack must stay 16 byte aligned for calls
+        a.patch32(state.frameSize, (state.maxSlots * 8 + 15) / 16 * 16);
+
+        result = (JITFunction) finalise();
+    }
+    catch (runtime_error&) {
+        //Leave the function to the interpreter
+        result = nullptr;
+    }
+
+    compiled[func] = result;
+    state = saved;
+
+    promoted("function " + func->identifier->identifier, func->lineNum, calls[func], result != nullptr, nullptr);
+
+    return result;
+}
+
+
+/*
+ * Compiles a loop which the interpreter is part way through running.
+ * The code starts by checking the loop's condition, as the interpreter does on a back edge,
+ * so a for loop's declaration is not compiled. Any variable which is not declared inside the loop
+ * is captured: it is copied from the argument array into the frame on entry and copied back on exit.
+ * Captured variables must not share slots with temporary values, so the loop is compiled twice.
+ */
+void JITVisitor::compileLoop(ASTStatement* loop, JITLoop& info) {
+
+    JITFunctionState saved = state;
+
+    info.attempted = true;
+    info.code = nullptr;
+
+    try {
+#if !defined(__x86_64__)
+        throw runtime_error("Native code can only be generated for x86-64.");
+#endif
+
+        //The first pass finds the captured variables, so that the second pass can give them slots
+        //before any temporary values are allocated
+        vector<JITCapture> captures;
+
+        for (int pass = 0; pass < 2; pass++) {
+            state = JITFunctionState();
+            state.region = true;
+            state.slots = 0;
+            state.maxSlots = 0;
+
+            Assembler& a = state.assembler;
+
+            //push rbp; mov rbp, rsp; sub rsp, frame size
+            a.emit({0x55, 0x48, 0x89, 0xE5, 0x48, 0x81, 0xEC});
+            state.frameSize = a.position();
+            a.emit32(0);
+
+            //Keep the argument array, mov [rbp + offset], rdi
+            int args = offsetOf(allocate());
+            a.emit({0x48, 0x89, 0xBD});
+            a.emit32(args);
+
+            //The captured variables are loaded at the end, so that the loop can start with its condition
+            size_t entry = a.jump({0xE9});
+            size_t body = a.position();
+
+
+            //Captured variables are stored in the outermost scope
+            pushScope();
+
+            for (JITCapture& capture : captures) {
+                capture.variable.offset = offsetOf(allocate());
+                state.scopes.front()[capture.id] = capture.variable;
+                state.captures.push_back(capture);
+            }
+
+            auto forLoop = dynamic_cast<ASTFor*>(loop);
+            if (forLoop != nullptr) {
+                emitLoop(forLoop->conditional, forLoop->block, forLoop->assignment);
+            }
+            else {
+                loop->accept(this);
+            }
+
+            popScope();
+
+            if (pass > 0 && state.captures.size() != captures.size()) {
+                throw runtime_error("Line " + to_string(loop->lineNum) + ": Captured variables changed.");
+            }
+            captures = state.captures;
+
+
+            //Write back every captured variable, mov rdi, [rbp + offset]
+            a.emit({0x48, 0x8B, 0xBD});
+            a.emit32(args);
+
+            for (size_t i = 0; i < captures.size(); i++) {
+                //mov rax, [rbp + offset]; mov [rdi + 8i], rax
+                a.emit({0x48, 0x8B, 0x85});
+                a.emit32(captures[i].variable.offset);
+                a.emit({0x48, 0x89, 0x87});
+                a.emit32((int32_t) (8 * i));
+            }
+
+            //leave; ret
+            a.emit({0xC9, 0xC3});
+
+
+            //Load every captured variable, then jump to the start of the loop
+            a.bind(entry);
+
+            for (size_t i = 0; i < captures.size(); i++) {
+                //mov rax, [rdi + 8i]; mov [rbp + offset], rax
+                a.emit({0x48, 0x8B, 0x87});
+                a.emit32((int32_t) (8 * i));
+                a.emit({0x48, 0x89, 0x85});
+                a.emit32(captures[i].variable.offset);
+            }
+
+            a.jumpTo({0xE9}, body);
+
+            //The stack must stay 16 byte aligned for calls
+            a.patch32(state.frameSize, (state.maxSlots * 8 + 15) / 16 * 16);
+        }
+
+        info.code = (JITFunction) finalise();
+        info.captures = captures;
+    }
+    catch (runtime_error&) {
+        //Leave the loop to the interpreter
+        info.code = nullptr;
+    }
+
+    state = saved;
+
+    string description = (dynamic_cast<ASTFor*>(loop) != nullptr) ? "for loop" : "while loop";
+    promoted(description, loop->lineNum, info.backEdges, info.code != nullptr, loop);
+}
+
+
+/*
+ * Compiles a loop starting from its condition, used by both for and while loops.
+ */
+void JITVisitor::emitLoop(ASTExpression* conditional, ASTBlock* block, ASTAssignment* increment) {
+    Assembler& a = state.assembler;
+
+    //Check the condition on every iteration
+    size_t start = a.position();
+    conditional->accept(this);
+    convert(BOOL);
+
+    //test eax, eax; je end
+    a.emit({0x85, 0xC0});
+    size_t end = a.jump({0x0F, 0x84});
+
+    //Run the block and the increment/assignment, then jump back to the condition
+    block->accept(this);
+
+    if (increment != nullptr) {
+        increment->accept(this);
+    }
+
+    a.jumpTo({0xE9}, start);
+    a.bind(end);
+}
+
+
+/*
+ * Reserves a stack slot, which is released by decrementing state.slots.
+ * Variables keep their slot for the rest of the function.
+ */
+int JITVisitor::allocate() {
+    int slot = state.slots++;
+
+    if (state.slots > state.maxSlots) {
+        state.maxSlots = state.slots;
+    }
+
+    return slot;
+}
+
+
+/*
+ * The offset of a slot from the frame pointer.
+ */
+int JITVisitor::offsetOf(int slot) {
+    return -8 * (slot + 1);
+}
+
+
+/*
+ * Finds the innermost variable with the given identifier, or null if it was not declared in the function.
+ * Loops capture any other variable from the interpreter's symbol table.
+ */
+JITVariable* JITVisitor::findVariable(const string& id) {
+    for (auto scope = state.scopes.rbegin(); scope != state.scopes.rend(); scope++) {
+        auto found = scope->find(id);
+
+        if (found != scope->end()) {
+            return &found->second;
+        }
+    }
+
+    //Only variables which currently have a value can be captured
+    if (!state.region || !table->isDeclared(id) || table->findSymbol(id)->second.value == nullptr) {
+        return nullptr;
+    }
+
+    VariableType type = table->getType(id);
+    if (type == STRING) {
+        throw runtime_error("Strings cannot be compiled.");
+    }
+
+    JITVariable variable = {offsetOf(allocate()), type};
+    state.captures.push_back(JITCapture{id, variable});
+
+    return &(state.scopes.front()[id] = variable);
+}
+
+
+void JITVisitor::pushScope() {
+    state.scopes.emplace_back();
+}
+
+
+void JITVisitor::popScope() {
+    state.scopes.pop_back();
+}
+
+
+/*
+ * Loads a value from the frame into eax, or xmm0 for floats.
+ */
+void JITVisitor::load(VariableType type, int offset) {
+    if (type == FLOAT) {
+        //movss xmm0, [rbp + offset]
+        state.assembler.emit({0xF3, 0x0F, 0x10, 0x85});
+    }
+    else {
+        //mov eax, [rbp + offset]
+        state.assembler.emit({0x8B, 0x85});
+    }
+
+    state.assembler.emit32(offset);
+}
+
+
+/*
+ * Stores eax, or xmm0 for floats, in the frame.
+ */
+void JITVisitor::store(VariableType type, int offset) {
+    if (type == FLOAT) {
+        //movss [rbp + offset], xmm0
+        state.assembler.emit({0xF3, 0x0F, 0x11, 0x85});
+    }
+    else {
+        //mov [rbp + offset], eax
+        state.assembler.emit({0x89, 0x85});
+    }
+
+    state.assembler.emit32(offset);
+}
+
+
+/*
+ * Moves the right operand of a binary operation out of the way, into ecx or xmm1.
+ */
+void JITVisitor::moveToSecond(VariableType type) {
+    if (type == FLOAT) {
+        //movaps xmm1, xmm0
+        state.assembler.emit({0x0F, 0x28, 0xC8});
+    }
+    else {
+        //mov ecx, eax
+        state.assembler.emit({0x89, 0xC1});
+    }
+}
+
+
+/*
+ * Converts the value of the last expression compiled to another type,
+ * in the same way as InterpreterVisitor::convertReturnedType().
+ * Conversions to bool use ecx and xmm1.
+ */
+void JITVisitor::convert(VariableType to) {
+    Assembler& a = state.assembler;
+
+    if (returnedType == STRING || to == STRING) {
+        throw runtime_error("Strings cannot be compiled.");
+    }
+
+    if (returnedType == to) {
+        return;
+    }
+
+    if (to == FLOAT) {
+        //cvtsi2ss xmm0, eax
+        a.emit({0xF3, 0x0F, 0x2A, 0xC0});
+    }
+    else if (to == INT && returnedType == FLOAT) {
+        //cvttss2si eax, xmm0
+        a.emit({0xF3, 0x0F, 0x2C, 0xC0});
+    }
+    else if (to == BOOL && returnedType == FLOAT) {
+        //Any value other than 0 is true, including NaN
+        //xorps xmm1, xmm1; ucomiss xmm0, xmm1; setne al; setp cl; or al, cl; movzx eax, al
+        a.emit({0x0F, 0x57, 0xC9, 0x0F, 0x2E, 0xC1, 0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC1, 0x08, 0xC8, 0x0F, 0xB6, 0xC0});
+    }
+    else if (to == BOOL && returnedType == INT) {
+        //test eax, eax; setne al; movzx eax, al
+        a.emit({0x85, 0xC0, 0x0F, 0x95, 0xC0, 0x0F, 0xB6, 0xC0});
+    }
+
+    //Bools are already stored as the ints 0 and 1
+    returnedType = to;
+}
+
+
+/*
+ * Calls a C++ function, with its arguments already in place.
+ */
+void JITVisitor::callHelper(void* address) {
+    //mov rax, address; call rax
+    state.assembler.emit({0x48, 0xB8});
+    state.assembler.emit64((int64_t) address);
+    state.assembler.emit({0xFF, 0xD0});
+}
+
+
+/*
+ * Visit Functions
+ */
+
+
+void JITVisitor::visit(ASTProgram*) {
+    throw runtime_error("Only functions can be compiled.");
+}
+
+
+void JITVisitor::visit(ASTAssignment* node) {
+
+    //Only the function's own variables can be assigned
+    JITVariable* variable = findVariable(node->identifier->identifier);
+    if (variable == nullptr) {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Only local variables can be compiled.");
+    }
+    JITVariable target = *variable;
+
+    //Evaluate the expression and store it in the variable's type
+    node->value->accept(this);
+    convert(target.type);
+    store(target.type, target.offset);
+}
+
+
+void JITVisitor::visit(ASTBinOp* node) {
+    Assembler& a = state.assembler;
+
+    //Boolean operations only need the operands as bools
+    if (node->op == AND || node->op == OR) {
+        node->lExpression->accept(this);
+        convert(BOOL);
+
+        int left = offsetOf(allocate());
+        store(BOOL, left);
+
+        node->rExpression->accept(this);
+        convert(BOOL);
+        moveToSecond(BOOL);
+        load(BOOL, left);
+        state.slots--;
+
+        if (node->op == AND) {
+            //and eax, ecx
+            a.emit({0x21, 0xC8});
+        } else {
+            //or eax, ecx
+            a.emit({0x09, 0xC8});
+        }
+
+        returnedType = BOOL;
+        return;
+    }
+
+
+    //Evaluate the left operand and keep it in the frame while the right operand is evaluated
+    node->lExpression->accept(this);
+    VariableType lType = returnedType;
+
+    int left = offsetOf(allocate());
+    store(lType, left);
+
+    node->rExpression->accept(this);
+    VariableType rType = returnedType;
+
+    if (lType == STRING || rType == STRING) {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Strings cannot be compiled.");
+    }
+
+
+    //Check which type the operation should be carried out in, as in the interpreter
+    if (lType == FLOAT || rType == FLOAT) {
+        //At least one operand is a float, widen both to floats
+        convert(FLOAT);
+        moveToSecond(FLOAT);
+        load(lType, left);
+        returnedType = lType;
+        convert(FLOAT);
+        state.slots--;
+
+        switch (node->op) {
+            case PLUS:
+                //addss xmm0, xmm1
+                a.emit({0xF3, 0x0F, 0x58, 0xC1});
+                break;
+            case MINUS:
+                //subss xmm0, xmm1
+                a.emit({0xF3, 0x0F, 0x5C, 0xC1});
+                break;
+            case MULT:
+                //mulss xmm0, xmm1
+                a.emit({0xF3, 0x0F, 0x59, 0xC1});
+                break;
+            case DIVIDE:
+                //divss xmm0, xmm1
+                a.emit({0xF3, 0x0F, 0x5E, 0xC1});
+                break;
+
+            //Comparisons are false if either operand is NaN, so they are chosen to test the carry and zero flags
+            case LESSTHAN:
+                //ucomiss xmm1, xmm0; seta al
+                a.emit({0x0F, 0x2E, 0xC8, 0x0F, 0x97, 0xC0});
+                break;
+            case LESSTHANEQUAL:
+                //ucomiss xmm1, xmm0; setae al
+                a.emit({0x0F, 0x2E, 0xC8, 0x0F, 0x93, 0xC0});
+                break;
+            case GREATERTHAN:
+                //ucomiss xmm0, xmm1; seta al
+                a.emit({0x0F, 0x2E, 0xC1, 0x0F, 0x97, 0xC0});
+                break;
+            case GREATERTHANEQUAL:
+                //ucomiss xmm0, xmm1; setae al
+                a.emit({0x0F, 0x2E, 0xC1, 0x0F, 0x93, 0xC0});
+                break;
+            case EQUALS:
+                //ucomiss xmm0, xmm1; sete al; setnp cl; and al, cl
+                a.emit({0x0F, 0x2E, 0xC1, 0x0F, 0x94, 0xC0, 0x0F, 0x9B, 0xC1, 0x20, 0xC8});
+                break;
+            case NOTEQUALS:
+                //ucomiss xmm0, xmm1; setne al; setp cl; or al, cl
+                a.emit({0x0F, 0x2E, 0xC1, 0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC1, 0x08, 0xC8});
+                break;
+            default:
+                throw runtime_error("Line " + to_string(node->lineNum) + ": Unknown Operator.");
+        }
+
+        if (node->op == PLUS || node->op == MINUS || node->op == MULT || node->op == DIVIDE) {
+            returnedType = FLOAT;
+        }
+        else {
+            //movzx eax, al
+            a.emit({0x0F, 0xB6, 0xC0});
+            returnedType = BOOL;
+        }
+    }
+
+    else {
+        //Both operands are ints (or bools), 32 bit registers wrap around on overflow like the interpreter
+        convert(INT);
+        moveToSecond(INT);
+        load(lType, left);
+        returnedType = lType;
+        convert(INT);
+        state.slots--;
+
+        //The setcc instruction for each comparison
+        uint8_t condition;
+
+        switch (node->op) {
+            case PLUS:
+                //add eax, ecx
+                a.emit({0x01, 0xC8});
+                returnedType = INT;
+                return;
+            case MINUS:
+                //sub eax, ecx
+                a.emit({0x29, 0xC8});
+                returnedType = INT;
+                return;
+            case MULT:
+                //imul eax, ecx
+                a.emit({0x0F, 0xAF, 0xC1});
+                returnedType = INT;
+                return;
+            case DIVIDE:
+                //Division always produces a float, calculated in double precision
+                //cvtsi2sd xmm0, eax; cvtsi2sd xmm1, ecx; divsd xmm0, xmm1; cvtsd2ss xmm0, xmm0
+                a.emit({0xF2, 0x0F, 0x2A, 0xC0, 0xF2, 0x0F, 0x2A, 0xC9, 0xF2, 0x0F, 0x5E, 0xC1, 0xF2, 0x0F, 0x5A, 0xC0});
+                returnedType = FLOAT;
+                return;
+
+            case LESSTHAN:
+                condition = 0x9C;   //setl
+                break;
+            case LESSTHANEQUAL:
+                condition = 0x9E;   //setle
+                break;
+            case GREATERTHAN:
+                condition = 0x9F;   //setg
+                break;
+            case GREATERTHANEQUAL:
+                condition = 0x9D;   //setge
+                break;
+            case EQUALS:
+                condition = 0x94;   //sete
+                break;
+            case NOTEQUALS:
+                condition = 0x95;   //setne
+                break;
+            default:
+                throw runtime_error("Line " + to_string(node->lineNum) + ": Unknown Operator.");
+        }
+
+        //cmp eax, ecx; setcc al; movzx eax, al
+        a.emit({0x39, 0xC8, 0x0F, condition, 0xC0, 0x0F, 0xB6, 0xC0});
+        returnedType = BOOL;
+    }
+
+}
+
+
+void JITVisitor::visit(ASTBlock* node) {
+    pushScope();
+
+    for (ASTStatement* statement : node->block) {
+        statement->accept(this);
+    }
+
+    popScope();
+}
+
+
+void JITVisitor::visit(ASTFor* node) {
+    pushScope();
+
+    //If there is a variable declaration, compile it
+    if (node->declaration != nullptr) {
+        node->declaration->accept(this);
+    }
+
+    emitLoop(node->conditional, node->block, node->assignment);
+
+    popScope();
+}
+
+
+void JITVisitor::visit(ASTFormalParam*) {
+    //Parameters are copied into the frame by compile()
+}
+
+
+void JITVisitor::visit(ASTFunctionCall* node) {
+    Assembler& a = state.assembler;
+
+    //Evaluate each parameter into an array of argument slots
+    //Slots are allocated downwards from the frame pointer, so the first argument is in the last slot
+    int count = (int) node->param.size();
+    int base = state.slots;
+    for (int i = 0; i < count; i++) {
+        allocate();
+    }
+
+    vector<VariableType> types;
+    for (int i = 0; i < count; i++) {
+        node->param[i]->accept(this);
+
+        if (returnedType == STRING) {
+            throw runtime_error("Line " + to_string(node->lineNum) + ": Strings cannot be compiled.");
+        }
+
+        types.push_back(returnedType);
+        store(returnedType, offsetOf(base + count - 1 - i));
+    }
+
+
+    //Find the function being called, which must also be compiled
+    ASTFunctionDecl* func = table->getFunction(node->identifier->identifier, &types);
+    if (func == nullptr) {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Unknown function.");
+    }
+
+    auto found = compiled.find(func);
+    JITFunction code = (found != compiled.end()) ? found->second : compile(func);
+
+    if (code == nullptr) {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Function " + node->identifier->identifier +
+                            " cannot be compiled.");
+    }
+
+
+    //lea rdi, [rbp + offset of the first argument]
+    a.emit({0x48, 0x8D, 0xBD});
+    a.emit32(offsetOf(base + count - 1));
+
+    callHelper((void*) code);
+    state.slots = base;
+
+    //Floats are returned as a bit pattern in eax
+    returnedType = func->returnType;
+    if (returnedType == FLOAT) {
+        //movd xmm0, eax
+        a.emit({0x66, 0x0F, 0x6E, 0xC0});
+    }
+}
+
+
+void JITVisitor::visit(ASTFunctionDecl* node) {
+    throw runtime_error("Line " + to_string(node->lineNum) + ": Nested functions cannot be compiled.");
+}
+
+
+void JITVisitor::visit(ASTIdentifier* node) {
+
+    //Variables of the caller or global variables may change between calls, so only locals can be compiled
+    JITVariable* variable = findVariable(node->identifier);
+    if (variable == nullptr) {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Only local variables can be compiled.");
+    }
+
+    load(variable->type, variable->offset);
+    returnedType = variable->type;
+}
+
+
+void JITVisitor::visit(ASTIf* node) {
+    Assembler& a = state.assembler;
+
+    pushScope();
+
+    //Check the condition
+    node->conditional->accept(this);
+    convert(BOOL);
+
+    //test eax, eax; je else
+    a.emit({0x85, 0xC0});
+    size_t skipIf = a.jump({0x0F, 0x84});
+
+    node->ifBlock->accept(this);
+
+    if (node->elseBlock != nullptr) {
+        //jmp end
+        size_t skipElse = a.jump({0xE9});
+
+        a.bind(skipIf);
+        node->elseBlock->accept(this);
+        a.bind(skipElse);
+    }
+    else {
+        a.bind(skipIf);
+    }
+
+    popScope();
+}
+
+
+void JITVisitor::visit(ASTLiteralBool* node) {
+    //mov eax, b
+    state.assembler.emit({0xB8});
+    state.assembler.emit32(node->b ? 1 : 0);
+    returnedType = BOOL;
+}
+
+
+void JITVisitor::visit(ASTLiteralFloat* node) {
+    uint32_t bits;
+    memcpy(&bits, &node->f, sizeof(bits));
+
+    //mov eax, bits; movd xmm0, eax
+    state.assembler.emit({0xB8});
+    state.assembler.emit32((int32_t) bits);
+    state.assembler.emit({0x66, 0x0F, 0x6E, 0xC0});
+    returnedType = FLOAT;
+}
+
+
+void JITVisitor::visit(ASTLiteralInt* node) {
+    //mov eax, i
+    state.assembler.emit({0xB8});
+    state.assembler.emit32(node->i);
+    returnedType = INT;
+}
+
+
+void JITVisitor::visit(ASTLiteralString* node) {
+    throw runtime_error("Line " + to_string(node->lineNum) + ": Strings cannot be compiled.");
+}
+
+
+void JITVisitor::visit(ASTPrint* node) {
+
+    //Evaluate the expression, which is the second argument of the helper
+    node->expression->accept(this);
+    Assembler& a = state.assembler;
+
+    switch (returnedType) {
+        case BOOL:
+            //mov esi, eax
+            a.emit({0x89, 0xC6});
+            //mov rdi, output
+            a.emit({0x48, 0xBF});
+            a.emit64((int64_t) output);
+            callHelper((void*) &printBool);
+            break;
+        case FLOAT:
+            //mov rdi, output
+            a.emit({0x48, 0xBF});
+            a.emit64((int64_t) output);
+            callHelper((void*) &printFloat);
+            break;
+        case INT:
+            //mov esi, eax
+            a.emit({0x89, 0xC6});
+            //mov rdi, output
+            a.emit({0x48, 0xBF});
+            a.emit64((int64_t) output);
+            callHelper((void*) &printInt);
+            break;
+        default:
+            throw runtime_error("Line " + to_string(node->lineNum) + ": Strings cannot be compiled.");
+    }
+}
+
+
+void JITVisitor::visit(ASTReturn* node) {
+
+    //A compiled loop cannot leave the function it is in
+    if (state.region) {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Loops containing return statements cannot be compiled.");
+    }
+
+    //Evaluate the returned expression in the function's return type
+    node->returnValue->accept(this);
+    convert(state.returnType);
+
+    if (returnedType == FLOAT) {
+        //movd eax, xmm0
+        state.assembler.emit({0x66, 0x0F, 0x7E, 0xC0});
+    }
+
+    //jmp epilogue
+    state.returns.push_back(state.assembler.jump({0xE9}));
+}
+
+
+void JITVisitor::visit(ASTUnary* node) {
+
+    //Evaluate the expression
+    node->expression->accept(this);
+
+    if (node->op == MINUS) {
+        //Negate ints directly, anything else is carried out as a float
+        if (returnedType == INT) {
+            //neg eax
+            state.assembler.emit({0xF7, 0xD8});
+        }
+        else {
+            convert(FLOAT);
+
+            //Flip the sign bit, mov eax, 0x80000000; movd xmm1, eax; xorps xmm0, xmm1
+            state.assembler.emit({0xB8});
+            state.assembler.emit32(INT32_MIN);
+            state.assembler.emit({0x66, 0x0F, 0x6E, 0xC8, 0x0F, 0x57, 0xC1});
+        }
+    }
+    else if (node->op == NOT) {
+        //xor eax, 1
+        convert(BOOL);
+        state.assembler.emit({0x83, 0xF0, 0x01});
+    }
+    else {
+        throw runtime_error("Line " + to_string(node->lineNum) + ": Unknown Operator.");
+    }
+}
+
+
+void JITVisitor::visit(ASTVariableDecl* node) {
+
+    //Evaluate the initial value in the variable's type
+    node->value->accept(this);
+    convert(node->type);
+
+    //Give the variable its own slot in the frame
+    JITVariable variable = {offsetOf(allocate()), node->type};
+    state.scopes.back()[node->identifier->identifier] = variable;
+
+    store(variable.type, variable.offset);
+}
+
+
+void JITVisitor::visit(ASTWhile* node) {
+    pushScope();
+    emitLoop(node->conditional, node->block, nullptr);
+    popScope();
+}
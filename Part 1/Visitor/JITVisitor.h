@@ -0,0 +1,175 @@
+#ifndef CPS2000_ASSIGNMENT_JITVISITOR_H
+#define CPS2000_ASSIGNMENT_JITVISITOR_H
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Visitor.h"
+#include "../JIT/Assembler.h"
+#include "../Runtime/OutputSink.h"
+#include "../SymbolTable/SymbolTable.h"
+
+#define DEFAULT_JIT_THRESHOLD 10    //Number of interpreted calls before a function is compiled
+#define DEFAULT_OSR_THRESHOLD 1000  //Number of interpreted iterations before a loop is compiled
+
+using namespace std;
+
+
+/*
+ * A function compiled to native code.
+ * Each argument and the returned value is stored in the low bits of a 64 bit slot,
+ * ints as 32 bit integers, floats as their single precision bit pattern and bools as 0 or 1.
+ */
+typedef long long (*JITFunction)(long long* args);
+
+
+/*
+ * A variable stored in the stack frame of a compiled function.
+ */
+struct JITVariable {
+    int offset;                 //Offset of the variable from the frame pointer
+    VariableType type;
+};
+
+
+/*
+ * A variable of the interpreter read by a compiled loop.
+ * Its value is copied into the frame when the loop is entered and copied back when it exits.
+ */
+struct JITCapture {
+    string id;
+    JITVariable variable;
+};
+
+
+/*
+ * A loop which the interpreter may move to native code part way through running it.
+ */
+struct JITLoop {
+    int backEdges;              //Number of iterations run by the interpreter
+    bool attempted;             //True once the loop has been compiled, or found to be impossible to compile
+    JITFunction code;           //Runs the rest of the loop, with the captured variables as arguments
+    vector<JITCapture> captures;
+    int entries;                //Number of times the interpreter transferred into the code
+};
+
+
+/*
+ * Records when a function or loop was compiled, for --tiering-stats.
+ */
+struct JITPromotion {
+    string description;
+    int lineNum;
+    int count;                  //Calls or iterations run by the interpreter first
+    double milliseconds;        //Time since the JITVisitor was created
+    bool compiled;              //False if the code could not be compiled
+    ASTStatement* loop;         //The loop promoted, or null for functions
+};
+
+
+/*
+ * Everything known about the function currently being compiled.
+ * Saved while compiling a function it calls.
+ */
+struct JITFunctionState {
+    Assembler assembler;
+    VariableType returnType;
+    vector<map<string, JITVariable>> scopes;   //Variables visible to the code, innermost scope last
+    int slots;                  //Number of 8 byte stack slots currently in use
+    int maxSlots;               //Size of the stack frame, in slots
+    size_t frameSize;           //Position of the frame size in the prologue, patched once it is known
+    vector<size_t> returns;     //Jumps from return statements to the epilogue
+    bool region;                //True when compiling a loop rather than a function
+    vector<JITCapture> captures;//Variables of the interpreter used by a loop
+};
+
+
+/*
+ * Compiles functions which only use bool, int and float values into x86-64 machine code.
+ * Functions are compiled once the interpreter has called them a number of times.
+ * Loops are compiled once they have run a number of iterations, and the interpreter then
+ * transfers into the compiled loop on its next back edge, so long running loops outside of
+ * functions are also compiled.
+ *
+ * Compiled code only reads the function's own parameters and locals, so functions which use
+ * strings, global variables or variables of their callers are left to the interpreter.
+ * Every value is kept in a slot of the stack frame, with eax or xmm0 holding the value of the
+ * last expression compiled, so the generated code evaluates expressions in the same order
+ * and with the same arithmetic as the InterpreterVisitor.
+ */
+class JITVisitor : public Visitor {
+public:
+    JITVisitor();
+    JITVisitor(int threshold, int loopThreshold);
+    ~JITVisitor();
+
+    JITFunction getCompiled(ASTFunctionDecl* func, SymbolTable* table);
+    bool transfer(ASTStatement* loop, SymbolTable* table);
+    void printStatistics(ostream& out);
+    void setOutput(OutputSink* output);
+
+    static long long toArgument(ASTLiteral* value);
+    static long long toArgument(VariableType type, bool b, float f, int i);
+    static void fromResult(long long result, VariableType type, bool* b, float* f, int* i);
+
+    void visit(ASTProgram*) override;
+    void visit(ASTAssignment*) override;
+    void visit(ASTBinOp*) override;
+    void visit(ASTBlock*) override;
+    void visit(ASTFor*) override;
+    void visit(ASTFormalParam*) override;
+    void visit(ASTFunctionCall*) override;
+    void visit(ASTFunctionDecl*) override;
+    void visit(ASTIdentifier*) override;
+    void visit(ASTIf*) override;
+    void visit(ASTLiteralBool*) override;
+    void visit(ASTLiteralFloat*) override;
+    void visit(ASTLiteralInt*) override;
+    void visit(ASTLiteralString*) override;
+    void visit(ASTPrint*) override;
+    void visit(ASTReturn*) override;
+    void visit(ASTUnary*) override;
+    void visit(ASTVariableDecl*) override;
+    void visit(ASTWhile*) override;
+
+
+private:
+    int threshold;                              //Number of calls before a function is compiled
+    int loopThreshold;                          //Number of iterations before a loop is compiled
+    map<ASTFunctionDecl*, int> calls;           //Number of interpreted calls to each function
+    map<ASTFunctionDecl*, JITFunction> compiled;//Compiled functions, null if a function cannot be compiled
+    map<ASTStatement*, JITLoop> loops;          //Every loop run by the interpreter
+
+    chrono::steady_clock::time_point start;     //When the JITVisitor was created
+    vector<JITPromotion> promotions;            //Every function and loop compiled, in order
+    vector<pair<void*, size_t>> mappings;       //The executable memory of all compiled code and its size
+
+    SymbolTable* table;         //Used to find the functions called by compiled code
+    OutputSink* output;         //Written to by compiled print statements
+    JITFunctionState state;     //The function being compiled
+    VariableType returnedType;  //Type of the value left in eax or xmm0 by the last expression compiled
+
+    JITFunction compile(ASTFunctionDecl* func);
+    void* finalise();
+    void compileLoop(ASTStatement* loop, JITLoop& info);
+    void promoted(const string& description, int lineNum, int count, bool compiled, ASTStatement* loop);
+    void emitLoop(ASTExpression* conditional, ASTBlock* block, ASTAssignment* increment);
+
+    int allocate();
+    static int offsetOf(int slot);
+    JITVariable* findVariable(const string& id);
+    void pushScope();
+    void popScope();
+
+    void load(VariableType type, int offset);
+    void store(VariableType type, int offset);
+    void moveToSecond(VariableType type);
+    void convert(VariableType to);
+    void callHelper(void* address);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_JITVISITOR_H
@@ -0,0 +1,407 @@
+#include "OptimiserVisitor.h"
+#include "CloneVisitor.h"
+
+
+OptimiserVisitor::OptimiserVisitor() {
+    this->unrollFactor = DEFAULT_UNROLL_FACTOR;
+    this->replacement = nullptr;
+    this->ownsTree = true;
+}
+
+OptimiserVisitor::OptimiserVisitor(int unrollFactor) {
+    this->unrollFactor = unrollFactor;
+    this->replacement = nullptr;
+    this->ownsTree = true;
+}
+
+
+/*
+ * Replaces a statement with the one chosen while visiting it, if any.
+ * Enclosing loops may have recorded multiplications inside the old statement, so it is only freed outside of any loop,
+ * and never if it was built in a BinaryLoader's arena.
+ */
+void OptimiserVisitor::replace(ASTStatement*& statement) {
+    if (replacement == nullptr) {
+        return;
+    }
+
+    if (ownsTree && loops.empty()) {
+        delete statement;
+    }
+
+    statement = replacement;
+    replacement = nullptr;
+}
+
+
+/*
+ * Checks if a for loop is a counted loop of the form
+ *      for (let i:int = a; i < n; i = i + c) or for (let i:int = a; i <= n; i = i + c)
+ * where c is an int literal and i is not changed inside the loop body.
+ * If it is, the loop is annotated so that the interpreter can run it with a native counter,
+ * and any multiplications of i by a loop invariant factor are reduced to additions.
+ */
+void OptimiserVisitor::findInductionVariable(ASTFor* node, const LoopBody& body) {
+
+    //Check the declaration, let i:int = a
+    if (node->declaration == nullptr || node->declaration->type != INT) {
+        return;
+    }
+    string id = node->declaration->identifier->identifier;
+
+
+    //Check the condition, i < n or i <= n
+    auto condition = dynamic_cast<ASTBinOp*>(node->conditional);
+    if (condition == nullptr || (condition->op != LESSTHAN && condition->op != LESSTHANEQUAL)) {
+        return;
+    }
+
+    auto lhs = dynamic_cast<ASTIdentifier*>(condition->lExpression);
+    if (lhs == nullptr || lhs->identifier != id) {
+        return;
+    }
+
+
+    //Check the increment, i = i + c, i = c + i or i = i - c
+    if (node->assignment == nullptr || node->assignment->identifier->identifier != id) {
+        return;
+    }
+
+    auto increment = dynamic_cast<ASTBinOp*>(node->assignment->value);
+    if (increment == nullptr || (increment->op != PLUS && increment->op != MINUS)) {
+        return;
+    }
+
+    auto lId = dynamic_cast<ASTIdentifier*>(increment->lExpression);
+    auto lInt = dynamic_cast<ASTLiteralInt*>(increment->lExpression);
+    auto rId = dynamic_cast<ASTIdentifier*>(increment->rExpression);
+    auto rInt = dynamic_cast<ASTLiteralInt*>(increment->rExpression);
+
+    int step;
+    if (lId != nullptr && lId->identifier == id && rInt != nullptr) {
+        step = (increment->op == PLUS) ? rInt->i : -rInt->i;
+    }
+    else if (increment->op == PLUS && lInt != nullptr && rId != nullptr && rId->identifier == id) {
+        step = lInt->i;
+    }
+    else {
+        return;
+    }
+
+
+    //The body must not change the induction variable or declare another variable with the same name
+    if (body.assigned.count(id) != 0 || body.declared.count(id) != 0) {
+        return;
+    }
+
+
+    //Short loops with a constant trip count are replaced by a copy of the body for each iteration
+    replacement = fullyUnroll(node, step, body);
+    if (replacement != nullptr) {
+        return;
+    }
+
+
+    //This is a counted loop
+    auto loop = new CountedLoop();
+    loop->op = condition->op;
+    loop->bound = condition->rExpression;
+    loop->invariantBound = isInvariant(condition->rExpression, id, body);
+    loop->step = step;
+
+    //Iterations can only be grouped together if the condition is checked against a fixed bound
+    loop->unroll = (loop->invariantBound && step > 0) ? unrollFactor : 1;
+
+
+    //Reduce any multiplications of i by an invariant factor, i*k or k*i
+    for (ASTBinOp* product : body.products) {
+
+        //Skip multiplications already reduced by an inner loop
+        if (product->induction != nullptr) {
+            continue;
+        }
+
+        ASTExpression* factor;
+        auto l = dynamic_cast<ASTIdentifier*>(product->lExpression);
+        auto r = dynamic_cast<ASTIdentifier*>(product->rExpression);
+
+        if (l != nullptr && l->identifier == id) {
+            factor = product->rExpression;
+        }
+        else if (r != nullptr && r->identifier == id) {
+            factor = product->lExpression;
+        }
+        else {
+            continue;
+        }
+
+        if (isInvariant(factor, id, body)) {
+            auto derived = new DerivedInduction();
+            derived->factor = factor;
+            derived->active = false;
+
+            product->induction = derived;
+            loop->derived.push_back(derived);
+        }
+    }
+
+    node->counted = loop;
+}
+
+
+/*
+ * Fully unrolls a counted loop if its initial value and bound are constants giving at most MAX_FULL_UNROLL iterations.
+ * Each iteration becomes a copy of the loop's block with the induction variable replaced by its value,
+ * so every iteration still runs in its own scope.
+ * Returns the block replacing the loop, or null if it cannot be unrolled.
+ */
+ASTBlock* OptimiserVisitor::fullyUnroll(ASTFor* node, int step, const LoopBody& body) {
+
+    //Functions could read the induction variable, so it must remain in the symbol table
+    if (unrollFactor <= 1 || step <= 0 || body.hasCall || body.hasLoop) {
+        return nullptr;
+    }
+
+    auto initial = dynamic_cast<ASTLiteralInt*>(node->declaration->value);
+    auto condition = (ASTBinOp*) node->conditional;
+    auto intBound = dynamic_cast<ASTLiteralInt*>(condition->rExpression);
+    auto floatBound = dynamic_cast<ASTLiteralFloat*>(condition->rExpression);
+
+    if (initial == nullptr || (intBound == nullptr && floatBound == nullptr)) {
+        return nullptr;
+    }
+
+
+    //Find the value of the induction variable on each iteration
+    vector<int> values;
+    long long i = initial->i;
+
+    while (values.size() <= MAX_FULL_UNROLL) {
+        bool inRange;
+        if (intBound != nullptr) {
+            inRange = (condition->op == LESSTHAN) ? (i < intBound->i) : (i <= intBound->i);
+        }
+        else {
+            inRange = (condition->op == LESSTHAN) ? ((float) i < floatBound->f) : ((float) i <= floatBound->f);
+        }
+
+        if (!inRange) {
+            break;
+        }
+
+        values.push_back((int) i);
+        i += step;
+    }
+
+    if (values.size() > MAX_FULL_UNROLL) {
+        return nullptr;
+    }
+
+
+    //Copy the block once for each iteration
+    string id = node->declaration->identifier->identifier;
+    vector<ASTStatement*> iterations;
+
+    for (int value : values) {
+        CloneVisitor cloner({{id, value}});
+        iterations.push_back(cloner.clone(node->block));
+    }
+
+    return new ASTBlock(iterations, node->lineNum);
+}
+
+
+/*
+ * Checks if an expression is guaranteed to evaluate to the same value on every iteration of a loop.
+ * Only literals and variables which are not changed by the body are considered invariant.
+ */
+bool OptimiserVisitor::isInvariant(ASTExpression* expression, const string& inductionVariable, const LoopBody& body) {
+
+    //Literals never change
+    if (dynamic_cast<ASTLiteral*>(expression) != nullptr) {
+        return true;
+    }
+
+    //Variables are invariant if nothing in the body can assign them
+    auto identifier = dynamic_cast<ASTIdentifier*>(expression);
+    if (identifier != nullptr) {
+        string id = identifier->identifier;
+
+        return id != inductionVariable && !body.hasCall
+                && body.assigned.count(id) == 0 && body.declared.count(id) == 0;
+    }
+
+    return false;
+}
+
+
+/*
+ * Visit Functions
+ */
+
+
+void OptimiserVisitor::visit(ASTProgram* node) {
+    ownsTree = node->owned;
+
+    //Optimise each statement, replacing it if required
+    for (ASTStatement*& statement : node->program) {
+        statement->accept(this);
+        replace(statement);
+    }
+}
+
+
+void OptimiserVisitor::visit(ASTAssignment* node) {
+    //Record the assignment in every loop we are inside of
+    for (LoopBody& body : loops) {
+        body.assigned.insert(node->identifier->identifier);
+    }
+
+    node->value->accept(this);
+}
+
+
+void OptimiserVisitor::visit(ASTBinOp* node) {
+    //Record multiplications which may be reduced by an enclosing loop
+    if (node->op == MULT && (dynamic_cast<ASTIdentifier*>(node->lExpression) != nullptr
+                             || dynamic_cast<ASTIdentifier*>(node->rExpression) != nullptr)) {
+        for (LoopBody& body : loops) {
+            body.products.push_back(node);
+        }
+    }
+
+    node->lExpression->accept(this);
+    node->rExpression->accept(this);
+}
+
+
+void OptimiserVisitor::visit(ASTBlock* node) {
+    //Optimise each statement, replacing it if required
+    for (ASTStatement*& statement : node->block) {
+        statement->accept(this);
+        replace(statement);
+    }
+}
+
+
+void OptimiserVisitor::visit(ASTFor* node) {
+
+    //The loop belongs to any enclosing loop's body
+    for (LoopBody& body : loops) {
+        body.hasLoop = true;
+    }
+
+    //So does its header
+    if (node->declaration != nullptr) {
+        node->declaration->accept(this);
+    }
+
+    node->conditional->accept(this);
+
+    if (node->assignment != nullptr) {
+        node->assignment->accept(this);
+    }
+
+
+    //Collect information about this loop's body
+    loops.push_back(LoopBody{{}, {}, false, false, {}});
+    node->block->accept(this);
+
+    LoopBody body = loops.back();
+    loops.pop_back();
+
+
+    findInductionVariable(node, body);
+}
+
+
+void OptimiserVisitor::visit(ASTFormalParam* node) {
+    //Nothing to optimise
+}
+
+
+void OptimiserVisitor::visit(ASTFunctionCall* node) {
+    //The function may assign global variables
+    for (LoopBody& body : loops) {
+        body.hasCall = true;
+    }
+
+    for (ASTExpression* param : node->param) {
+        param->accept(this);
+    }
+}
+
+
+void OptimiserVisitor::visit(ASTFunctionDecl* node) {
+    node->block->accept(this);
+}
+
+
+void OptimiserVisitor::visit(ASTIdentifier* node) {
+    //Nothing to optimise
+}
+
+
+void OptimiserVisitor::visit(ASTIf* node) {
+    node->conditional->accept(this);
+    node->ifBlock->accept(this);
+
+    if (node->elseBlock != nullptr) {
+        node->elseBlock->accept(this);
+    }
+}
+
+
+void OptimiserVisitor::visit(ASTLiteralBool* node) {
+    //Nothing to optimise
+}
+
+
+void OptimiserVisitor::visit(ASTLiteralFloat* node) {
+    //Nothing to optimise
+}
+
+
+void OptimiserVisitor::visit(ASTLiteralInt* node) {
+    //Nothing to optimise
+}
+
+
+void OptimiserVisitor::visit(ASTLiteralString* node) {
+    //Nothing to optimise
+}
+
+
+void OptimiserVisitor::visit(ASTPrint* node) {
+    node->expression->accept(this);
+}
+
+
+void OptimiserVisitor::visit(ASTReturn* node) {
+    node->returnValue->accept(this);
+}
+
+
+void OptimiserVisitor::visit(ASTUnary* node) {
+    node->expression->accept(this);
+}
+
+
+void OptimiserVisitor::visit(ASTVariableDecl* node) {
+    //Record the declaration in every loop we are inside of
+    for (LoopBody& body : loops) {
+        body.declared.insert(node->identifier->identifier);
+    }
+
+    node->value->accept(this);
+}
+
+
+void OptimiserVisitor::visit(ASTWhile* node) {
+    for (LoopBody& body : loops) {
+        body.hasLoop = true;
+    }
+
+    node->conditional->accept(this);
+    node->block->accept(this);
+}
@@ -0,0 +1,73 @@
+#ifndef CPS2000_ASSIGNMENT_OPTIMISERVISITOR_H
+#define CPS2000_ASSIGNMENT_OPTIMISERVISITOR_H
+
+#include <string>
+#include <set>
+#include <vector>
+#include "Visitor.h"
+#include "../AST/AST.h"
+
+#define DEFAULT_UNROLL_FACTOR 4     //Number of iterations run between each check of a loop's condition
+#define MAX_FULL_UNROLL 16          //Loops with a constant trip count up to this size are fully unrolled
+
+using namespace std;
+
+
+/*
+ * Information collected about the body of a loop while it is being visited.
+ * Used to decide whether the loop can be optimised.
+ */
+struct LoopBody {
+    set<string> assigned;       //Identifiers assigned anywhere in the body
+    set<string> declared;       //Identifiers declared anywhere in the body
+    bool hasCall;               //True if the body calls a function (which may assign globals)
+    bool hasLoop;               //True if the body contains another loop
+    vector<ASTBinOp*> products; //Multiplications with an identifier operand
+};
+
+
+/*
+ * Optimises a semantically checked program.
+ * Should be run after the SemanticVisitor and before the InterpreterVisitor.
+ */
+class OptimiserVisitor : public Visitor {
+public:
+    OptimiserVisitor();
+    explicit OptimiserVisitor(int unrollFactor);
+
+    void visit(ASTProgram*) override;
+    void visit(ASTAssignment*) override;
+    void visit(ASTBinOp*) override;
+    void visit(ASTBlock*) override;
+    void visit(ASTFor*) override;
+    void visit(ASTFormalParam*) override;
+    void visit(ASTFunctionCall*) override;
+    void visit(ASTFunctionDecl*) override;
+    void visit(ASTIdentifier*) override;
+    void visit(ASTIf*) override;
+    void visit(ASTLiteralBool*) override;
+    void visit(ASTLiteralFloat*) override;
+    void visit(ASTLiteralInt*) override;
+    void visit(ASTLiteralString*) override;
+    void visit(ASTPrint*) override;
+    void visit(ASTReturn*) override;
+    void visit(ASTUnary*) override;
+    void visit(ASTVariableDecl*) override;
+    void visit(ASTWhile*) override;
+
+
+private:
+    vector<LoopBody> loops;     //The bodies of the loops currently being visited, innermost last
+    int unrollFactor;           //Number of copies of the body run by a partially unrolled loop
+    ASTStatement* replacement;  //Replaces the last statement visited in its block, if set
+    bool ownsTree;              //False if the program was loaded into an arena, so replaced statements cannot be freed
+
+    void replace(ASTStatement*& statement);
+    void findInductionVariable(ASTFor* node, const LoopBody& body);
+    ASTBlock* fullyUnroll(ASTFor* node, int step, const LoopBody& body);
+    bool isInvariant(ASTExpression* expression, const string& inductionVariable, const LoopBody& body);
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_OPTIMISERVISITOR_H
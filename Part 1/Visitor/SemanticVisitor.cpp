@@ -4,7 +4,27 @@ bool doTypesMatch(VariableType expected, VariableType actual);
 VariableType opReturnType(VariableType lType, Operator op, VariableType rType);
 
 
-SemanticVisitor::SemanticVisitor() = default;
+SemanticVisitor::SemanticVisitor() {
+    this->retainGlobals = false;
+}
+
+
+/*
+ * Leaves the global scope of each program on the table, so the caller can keep its declarations
+ * for checking the next program.
+ */
+void SemanticVisitor::setRetainGlobals(bool enabled) {
+    this->retainGlobals = enabled;
+}
+
+
+/*
+ * The symbol table used to check the program.
+ */
+SymbolTable* SemanticVisitor::getTable() {
+    return &table;
+}
+
 
 /*
  * Checks whether two variable types are the same.
@@ -62,26 +82,32 @@ VariableType opReturnType(VariableType lType, Operator op, VariableType rType) {
 
     switch(op) {
 
-        case MULT:
         case DIVIDE:
-            //Multiplicative Op, we will carry out the actual operation with floats,
-            //we can then convert back to the appropriate type (eg. int) later
+            //Division always produces a float
             if (doTypesMatch(FLOAT, lType) && doTypesMatch(FLOAT, rType)){
                 return FLOAT;
             }
             break;
 
 
+        case MULT:
+            //Multiplicative Op, ints are only widened to floats if the other operand is a float
+            if (doTypesMatch(FLOAT, lType) && doTypesMatch(FLOAT, rType)){
+                return (lType == FLOAT || rType == FLOAT) ? FLOAT : INT;
+            }
+            break;
+
+
         case PLUS:
         case MINUS:
             //Additive op, Both types must be compatible
-            if (doTypesMatch(lType, rType)) {
-                //The right type can be converted to the left type, the resulting value can be lType
-                return lType;
+            if (lType == STRING && rType == STRING) {
+                //Strings can only be concatenated
+                return (op == PLUS) ? STRING : INCOMPATIBLE;
             }
-            if (doTypesMatch(rType, lType)) {
-                //The right type can be converted to the right type, the resulting value can be the rType
-                return rType;
+            if (doTypesMatch(lType, rType)) {
+                //Numeric values, ints are only widened to floats if the other operand is a float
+                return (lType == FLOAT || rType == FLOAT) ? FLOAT : INT;
             }
             break;
 
@@ -133,8 +159,10 @@ void SemanticVisitor::visit(ASTProgram *node) {
         statement->accept(this);
     }
 
-    //Exit the scope
-    table.pop();
+    //Exit the scope, unless the caller keeps it
+    if (!retainGlobals) {
+        table.pop();
+    }
 }
 
 
@@ -12,6 +12,9 @@ class SemanticVisitor : public Visitor {
 public:
     SemanticVisitor();
 
+    void setRetainGlobals(bool enabled);
+    SymbolTable* getTable();
+
     void visit(ASTProgram*) override;
     void visit(ASTAssignment*) override;
     void visit(ASTBinOp*) override;
@@ -37,6 +40,7 @@ private:
     SymbolTable table;          //The stack of symbol tables, each table in the stack corresponds to a scope
     VariableType returnedType;  //The variable type returned by the last node that was visited.
     bool returnStatement;       //True if the last statement was a return statement, used in function declaration
+    bool retainGlobals;         //True if the program's global scope is left on the table once it is checked
 
 };
 
@@ -0,0 +1,26 @@
+#ifndef CPS2000_ASSIGNMENT_SUPERINSTRUCTIONS_H
+#define CPS2000_ASSIGNMENT_SUPERINSTRUCTIONS_H
+
+
+/*
+ * A superinstruction runs a node together with its leaf operands in a single handler,
+ * rather than dispatching to a visit function for each operand.
+ *
+ * Only the patterns listed in Superinstructions.inc are compiled into the interpreter.
+ * The list is generated by the Superinstructions tool from a profile of a corpus of programs.
+ * Each entry is SUPERINSTRUCTION(Node, Left, Right), where Node is BinOp for a binary operation
+ * or Assignment for an assignment of a binary operation, and Left and Right are the classes of
+ * the binary operation's operands.
+ */
+enum Superinstruction : int {
+    UNSELECTED = 0,     //The interpreter has not chosen a superinstruction for the node yet
+    NOT_FUSED,          //No superinstruction matches the node
+
+#define SUPERINSTRUCTION(Node, Left, Right) Node##_##Left##_##Right,
+#include "Superinstructions.inc"
+#undef SUPERINSTRUCTION
+};
+
+
+
+#endif //CPS2000_ASSIGNMENT_SUPERINSTRUCTIONS_H
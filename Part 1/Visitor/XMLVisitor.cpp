@@ -1,3 +1,7 @@
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
 #include "XMLVisitor.h"
 #include "../AST/AST.h"
 
@@ -14,30 +18,74 @@ XMLVisitor::XMLVisitor() {
     //Open File
     this->file.open(DEFAULT_FILENAME);
     this->indent = 0;
+    this->threads = 1;
+    this->buffer.reserve(XML_BUFFER_SIZE);
 }
 
 XMLVisitor::XMLVisitor(const string& filename) {
     //Open File
     this->file.open(filename);
     this->indent = 0;
+    this->threads = 1;
+    this->buffer.reserve(XML_BUFFER_SIZE);
+}
+
+//Keeps all of the XML in the buffer, rather than writing it to a file
+XMLVisitor::XMLVisitor(int indent) {
+    this->indent = indent;
+    this->threads = 1;
 }
 
 XMLVisitor::~XMLVisitor() {
     //Close file
+    flush();
     this->file.close();
 }
 
 
+/*
+ * Sets the number of threads used to write the top level statements of a program.
+ */
+void XMLVisitor::setThreads(int threads) {
+    this->threads = threads;
+}
+
+
 /*
  * Adds indentation at the start of the line
  */
 void XMLVisitor::addIndent() {
-    for (int i = 0; i < indent; i++) {
-        file << "\t";
+    //Keep a string of tabs at least as long as the deepest indentation so far
+    if ((size_t) indent > tabs.size()) {
+        tabs.resize(2 * indent, '\t');
+    }
+
+    buffer.append(tabs, 0, indent);
+}
+
+
+/*
+ * Ends the current line, writing the buffer to the file once it is full.
+ */
+void XMLVisitor::endLine() {
+    buffer.push_back('\n');
+
+    if (buffer.size() >= XML_BUFFER_SIZE && file.is_open()) {
+        flush();
     }
 }
 
 
+/*
+ * Writes the buffer to the file.
+ */
+void XMLVisitor::flush() {
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    buffer.clear();
+}
+
+
 /*
  * Visit functions.
  */
@@ -45,25 +93,107 @@ void XMLVisitor::addIndent() {
 void XMLVisitor::visit(ASTProgram* node) {
     //Open program block
     addIndent();
-    file << "<Program>" << endl;
+    buffer.append("<Program>");
+    endLine();
     indent++;
 
     //Visit each statement
-    for (ASTStatement* s : node->program) {
-        s->accept(this);
+    if (threads > 1 && node->program.size() > 1) {
+        visitParallel(node);
+    }
+    else {
+        for (ASTStatement* s : node->program) {
+            s->accept(this);
+        }
     }
 
     //Close program block
     indent--;
     addIndent();
-    file << "</Program>" << endl;
+    buffer.append("</Program>");
+    endLine();
+
+    //The whole program has been written
+    flush();
+}
+
+
+/*
+ * Writes the top level statements of a program on several threads.
+ * The statements are split into groups of consecutive statements, which the threads take in turn and
+ * write to their own buffers. The buffers are then written to the file in order as they are finished,
+ * so the file is the same as writing each statement on this thread.
+ */
+void XMLVisitor::visitParallel(ASTProgram* node) {
+    size_t count = node->program.size();
+    size_t groups = min(count, (size_t) threads * XML_TASKS_PER_THREAD);
+
+    vector<promise<string>> results(groups);
+    atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        for (size_t group = next++; group < groups; group = next++) {
+            //Split the statements as evenly as possible
+            size_t start = count * group / groups;
+            size_t end = count * (group + 1) / groups;
+
+            try {
+                results[group].set_value(statements(node, start, end, indent));
+            }
+            catch (...) {
+                results[group].set_exception(current_exception());
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+
+    //Write each group once it is done, while later groups are still being written
+    flush();
+    exception_ptr error;
+
+    for (promise<string>& result : results) {
+        try {
+            string xml = result.get_future().get();
+            file.write(xml.data(), xml.size());
+        }
+        catch (...) {
+            error = current_exception();
+        }
+    }
+
+    for (thread& t : pool) {
+        t.join();
+    }
+
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+
+/*
+ * Returns the XML of a range of top level statements, starting at the given indentation.
+ */
+string XMLVisitor::statements(ASTProgram* node, size_t start, size_t end, int indent) {
+    XMLVisitor visitor(indent);
+
+    for (size_t i = start; i < end; i++) {
+        node->program[i]->accept(&visitor);
+    }
+
+    return move(visitor.buffer);
 }
 
 
 void XMLVisitor::visit(ASTAssignment* node) {
     //Open assignment Block
     addIndent();
-    file << "<Assignment>" << endl;
+    buffer.append("<Assignment>");
+    endLine();
     indent++;
 
     //Print values
@@ -73,14 +203,16 @@ void XMLVisitor::visit(ASTAssignment* node) {
     //Close assignment block
     indent--;
     addIndent();
-    file << "</Assignment>" << endl;
+    buffer.append("</Assignment>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTBinOp* node) {
     //Open binary op block
     addIndent();
-    file << "<BinOp op=\"" << opString[node->op] << "\">" << endl;
+    buffer.append("<BinOp op=\"").append(opString[node->op]).append("\">");
+    endLine();
     indent++;
 
     //visit operands
@@ -90,14 +222,16 @@ void XMLVisitor::visit(ASTBinOp* node) {
     //Close binary op block
     indent--;
     addIndent();
-    file << "</BinOp>" << endl;
+    buffer.append("</BinOp>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTBlock* node) {
     //Open block block
     addIndent();
-    file << "<Block>" << endl;
+    buffer.append("<Block>");
+    endLine();
     indent++;
 
     //Visit each statement in the block
@@ -108,19 +242,22 @@ void XMLVisitor::visit(ASTBlock* node) {
     //Close block block
     indent--;
     addIndent();
-    file << "</Block>" << endl;
+    buffer.append("</Block>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTFor* node) {
     //Open for block
     addIndent();
-    file << "<for>" << endl;
+    buffer.append("<for>");
+    endLine();
     indent++;
 
     //Visit assignment/conditional/assignment (if they exist)
     addIndent();
-    file << "<Condition>" << endl;
+    buffer.append("<Condition>");
+    endLine();
     indent++;
 
     if (node->declaration != nullptr) {
@@ -135,32 +272,37 @@ void XMLVisitor::visit(ASTFor* node) {
 
     indent--;
     addIndent();
-    file << "</Condition>" << endl;
+    buffer.append("</Condition>");
+    endLine();
 
 
     //Print main block
     addIndent();
-    file << "<Do>" << endl;
+    buffer.append("<Do>");
+    endLine();
     indent++;
 
     node->block->accept(this);
 
     indent--;
     addIndent();
-    file << "</Do>" << endl;
+    buffer.append("</Do>");
+    endLine();
 
 
     //Close for block
     indent--;
     addIndent();
-    file << "</Assignment>" << endl;
+    buffer.append("</Assignment>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTFormalParam* node) {
     //Open param line
     addIndent();
-    file << "<Param type=\"" << typeString[node->type] << "\">" << endl;
+    buffer.append("<Param type=\"").append(typeString[node->type]).append("\">");
+    endLine();
     indent++;
 
     //Print id
@@ -169,14 +311,16 @@ void XMLVisitor::visit(ASTFormalParam* node) {
     //Close param line
     indent--;
     addIndent();
-    file << "</Param>" << endl;
+    buffer.append("</Param>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTFunctionCall* node) {
     //Open assignment block
     addIndent();
-    file << "<Function>" << endl;
+    buffer.append("<Function>");
+    endLine();
     indent++;
 
     //Print function name
@@ -184,7 +328,8 @@ void XMLVisitor::visit(ASTFunctionCall* node) {
 
     //Open Param Block
     addIndent();
-    file << "<Params>" << endl;
+    buffer.append("<Params>");
+    endLine();
     indent++;
 
     //Print all params
@@ -195,19 +340,22 @@ void XMLVisitor::visit(ASTFunctionCall* node) {
     //Close assignment block
     indent--;
     addIndent();
-    file << "</Params>" << endl;
+    buffer.append("</Params>");
+    endLine();
 
     //Close function block
     indent--;
     addIndent();
-    file << "</Function>" << endl;
+    buffer.append("</Function>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTFunctionDecl* node) {
     //Open function block
     addIndent();
-    file << "<Function return=\"" << typeString[node->returnType] << "\">" << endl;
+    buffer.append("<Function return=\"").append(typeString[node->returnType]).append("\">");
+    endLine();
     indent++;
 
     //Print id
@@ -215,7 +363,8 @@ void XMLVisitor::visit(ASTFunctionDecl* node) {
 
     //Open Param List
     addIndent();
-    file << "<Params>" << endl;
+    buffer.append("<Params>");
+    endLine();
     indent++;
 
     //Print each param
@@ -226,7 +375,8 @@ void XMLVisitor::visit(ASTFunctionDecl* node) {
     //End Param list
     indent--;
     addIndent();
-    file << "</Params>" << endl;
+    buffer.append("</Params>");
+    endLine();
 
     //Print block
     node->block->accept(this);
@@ -234,32 +384,37 @@ void XMLVisitor::visit(ASTFunctionDecl* node) {
     //Close function line
     indent--;
     addIndent();
-    file << "</Function>" << endl;
+    buffer.append("</Function>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTIdentifier* node) {
     addIndent();
-    file << "<Id>" << node->identifier << "</Id>" << endl;
+    buffer.append("<Id>").append(node->identifier).append("</Id>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTIf* node) {
     //Open if block
     addIndent();
-    file << "<If>" << endl;
+    buffer.append("<If>");
+    endLine();
     indent++;
 
     //Print the conditional statement
     addIndent();
-    file << "<Condition>" << endl;
+    buffer.append("<Condition>");
+    endLine();
     indent++;
 
     node->conditional->accept(this);
 
     indent--;
     addIndent();
-    file << "</Condition>" << endl;
+    buffer.append("</Condition>");
+    endLine();
 
     //Print the main block
     node->ifBlock->accept(this);
@@ -269,21 +424,24 @@ void XMLVisitor::visit(ASTIf* node) {
     if (node->elseBlock != nullptr) {
         //Print the conditional statement
         addIndent();
-        file << "<Else>" << endl;
+        buffer.append("<Else>");
+        endLine();
         indent++;
 
         node->elseBlock->accept(this);
 
         indent--;
         addIndent();
-        file << "</Else>" << endl;
+        buffer.append("</Else>");
+        endLine();
     }
 
 
     //Close the if block
     indent--;
     addIndent();
-    file << "</If>" << endl;
+    buffer.append("</If>");
+    endLine();
 }
 
 
@@ -293,35 +451,40 @@ void XMLVisitor::visit(ASTLiteralBool* node) {
 
     //Open Literal Line
     addIndent();
-    file << "<Literal type=\"bool\">" << value << "</Literal>" << endl;
+    buffer.append("<Literal type=\"bool\">").append(value).append("</Literal>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTLiteralFloat* node) {
     //Open Literal Line
     addIndent();
-    file << "<Literal type=\"float\">" << to_string(node->f) << "</Literal>" << endl;
+    buffer.append("<Literal type=\"float\">").append(to_string(node->f)).append("</Literal>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTLiteralInt* node) {
     //Open Literal Line
     addIndent();
-    file << "<Literal type=\"int\">" << to_string(node->i) << "</Literal>" << endl;
+    buffer.append("<Literal type=\"int\">").append(to_string(node->i)).append("</Literal>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTLiteralString* node) {
     //Open Literal Line
     addIndent();
-    file << "<Literal type=\"string\">" << node->s << "</Literal>" << endl;
+    buffer.append("<Literal type=\"string\">").append(node->s.data(), node->s.length()).append("</Literal>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTPrint* node) {
     //Open print block
     addIndent();
-    file << "<print>" << endl;
+    buffer.append("<print>");
+    endLine();
     indent++;
 
     //Print Expression
@@ -330,14 +493,16 @@ void XMLVisitor::visit(ASTPrint* node) {
     //Close print block
     indent--;
     addIndent();
-    file << "</print>" << endl;
+    buffer.append("</print>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTReturn* node) {
     //Open return block
     addIndent();
-    file << "<return>" << endl;
+    buffer.append("<return>");
+    endLine();
     indent++;
 
     //Print Expression
@@ -346,14 +511,16 @@ void XMLVisitor::visit(ASTReturn* node) {
     //Close return block
     indent--;
     addIndent();
-    file << "</return>" << endl;
+    buffer.append("</return>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTUnary* node) {
     //Open Unary Block
     addIndent();
-    file << "<UnaryOp op=\"" << opString[node->op] << "\">" << endl;
+    buffer.append("<UnaryOp op=\"").append(opString[node->op]).append("\">");
+    endLine();
     indent++;
 
     //Print the expression
@@ -362,14 +529,16 @@ void XMLVisitor::visit(ASTUnary* node) {
     //Close Unary block
     indent--;
     addIndent();
-    file << "</UnaryOp>" << endl;
+    buffer.append("</UnaryOp>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTVariableDecl* node) {
     //Open declaration block
     addIndent();
-    file << "<VariableDecl type=\"" << typeString[node->type] << "\">" << endl;
+    buffer.append("<VariableDecl type=\"").append(typeString[node->type]).append("\">");
+    endLine();
     indent++;
 
     //Print the identifier
@@ -381,41 +550,48 @@ void XMLVisitor::visit(ASTVariableDecl* node) {
     //Close the declaration block
     indent--;
     addIndent();
-    file << "</VariableDecl>" << endl;
+    buffer.append("</VariableDecl>");
+    endLine();
 }
 
 
 void XMLVisitor::visit(ASTWhile* node) {
     //Open while block
     addIndent();
-    file << "<while>" << endl;
+    buffer.append("<while>");
+    endLine();
     indent++;
 
     //Print the conditional
     addIndent();
-    file << "<Condition>" << endl;
+    buffer.append("<Condition>");
+    endLine();
     indent++;
 
     node->conditional->accept(this);
 
     indent--;
     addIndent();
-    file << "</Condition>" << endl;
+    buffer.append("</Condition>");
+    endLine();
 
     //Print the block
     addIndent();
-    file << "<Do>" << endl;
+    buffer.append("<Do>");
+    endLine();
     indent++;
 
     node->block->accept(this);
 
     indent--;
     addIndent();
-    file << "</Do>" << endl;
+    buffer.append("</Do>");
+    endLine();
 
     //Close the while block
     indent--;
     addIndent();
-    file << "</while>" << endl;
+    buffer.append("</while>");
+    endLine();
 }
 
@@ -6,6 +6,8 @@
 #include "Visitor.h"
 
 #define DEFAULT_FILENAME "AST.xml"
+#define XML_BUFFER_SIZE (1 << 20)   //Bytes of XML collected before they are written to the file
+#define XML_TASKS_PER_THREAD 16     //Top level statements are split into this many groups per thread, to balance the work
 
 using namespace std;
 
@@ -16,6 +18,8 @@ public:
     explicit XMLVisitor(const string& filename);
     ~XMLVisitor();
 
+    void setThreads(int threads);
+
     void visit(ASTProgram*) override;
     void visit(ASTAssignment*) override;
     void visit(ASTBinOp*) override;
@@ -38,9 +42,18 @@ public:
 
 private:
     int indent;
+    int threads;    //Threads used to write the top level statements, 1 writes them in order on this thread
     ofstream file;
+    string buffer;  //Lines which have not been written to the file yet
+    string tabs;    //Indentation is copied from the start of this string
+
+    explicit XMLVisitor(int indent);
 
     void addIndent();
+    void endLine();
+    void flush();
+    void visitParallel(ASTProgram* node);
+    static string statements(ASTProgram* node, size_t start, size_t end, int indent);
 };
 
 
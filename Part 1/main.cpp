@@ -1,66 +1,605 @@
 #include <iostream>
+#include <fstream>
 #include <cerrno>
+#include <cstdlib>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
 
+#include "./Binary/BinaryLoader.h"
+#include "./Driver/Batch.h"
+#include "./Driver/Repl.h"
+#include "./Driver/Server.h"
+#include "./Driver/Stream.h"
+#include "./Driver/Watch.h"
+#include "./Binary/CompileCache.h"
+#include "./Visitor/BinaryVisitor.h"
+#include "./Visitor/CVisitor.h"
 #include "./Visitor/IntepreterVisitor.h"
+#include "./Visitor/JITVisitor.h"
+#include "./Visitor/OptimiserVisitor.h"
 #include "./Visitor/SemanticVisitor.h"
 #include "./Visitor/XMLVisitor.h"
+#include "./Lexer/Lexer.h"
 #include "./Parser/Parser.h"
+#include "./Runtime/OutputSink.h"
+#include "./Runtime/Statistics.h"
+#include "./Visitor/CountVisitor.h"
 
 
 using namespace std;
 
 
 string readFile(char* fileName);
+void writeFile(const string& fileName, const string& contents);
+int compileAndRun(const string& source);
+int runBatch(const vector<char*>& fileNames, bool lists, const BatchOptions& options);
 
 
 
 /*
- * Expected Arguments: File name
+ * Expected Arguments: [Options] File name...
+ * The file can be TeaLang source, or a binary AST written by --emit-ast.
+ * Given more than one file, or --batch, the files are run as a batch of TeaLang scripts instead.
+ *
+ * Each run only pays for the stages it uses. The program is run unless --check-only, --dump-tokens,
+ * --emit-ast or --emit-c is given, and --run runs it after those stages as well.
+ *
+ * Options:
+ *      --run               Run the program, the default unless another stage was asked for
+ *      --check-only        Parse and check the program without running it, exiting with 1 if it is not valid
+ *      --dump-tokens       Print the tokens of the source
+ *      --emit-xml[=path]   Write the parsed program as XML, to AST.xml by default
+ *      --time-stages       Print how long each stage took to stderr
+ *      --stats=json        Print the time taken by each stage and counters from the run to stderr as JSON
+ *      --no-optimise       Run the program exactly as it was parsed
+ *      --unroll=N          Unroll counted loops by a factor of N, 1 disables unrolling
+ *      --emit-c[=path]     Translate the program to C, written to the given file or stdout
+ *      --aot               Compile the program to C, build it with the system C compiler and run it
+ *      --emit-ast=path     Write the checked program to a binary AST file, which loads faster than parsing
+ *      --cache-dir=path    Keep checked programs in this directory, so running the same source again skips checking it
+ *      --cache-size=N      Remove the least recently used programs once the cache is larger than N MiB
+ *      --xml-threads=N     Write the top level statements of the XML on N threads
+ *      --jit               Compile functions to native code once they have been called often enough
+ *      --jit-threshold=N   Compile a function on its Nth call, 1 compiles functions before their first call runs
+ *      --osr-threshold=N   Compile a loop after N iterations, and run its remaining iterations natively
+ *      --tiering-stats     Print the functions and loops compiled by the JIT to stderr, implies --jit
+ *      --no-superinstructions  Run every node through its own visit function
+ *      --count-dispatches  Print the number of visit functions run by the interpreter to stderr
+ *      --flush=POLICY      When printed output is written: line, full or never-until-exit
+ *                          Defaults to line in a terminal and full otherwise
+ *      --async-output      Write printed output on a separate thread, so a slow reader does not block the program
+ *
+ * Limit Options, which stop an interpreted run with an error once it goes over them, and disable --jit:
+ *      --max-ops=N         Run at most N loop iterations and function calls
+ *      --deadline=N        Run for at most N milliseconds
+ *      --max-depth=N       Nest function calls at most N deep
+ *      --max-memory=N      Hold at most N MiB of string values
+ *
+ * Batch Options, only the options for running the program apply to each script:
+ *      --batch             Each file is a list of scripts to run, one per line
+ *      --batch-threads=N   Run N scripts at the same time, defaults to the number of CPUs
+ *      --batch-output=DIR  Write the output of each script to its own file in DIR, rather than prefixing
+ *                          each line with the script's name on stdout
+ *
+ * Server Options, only the options for running the program apply to each script:
+ *      --serve=path        Run scripts sent to a Unix domain socket at path until stopped, see TeaLangClient
+ *
+ * Watch Options:
+ *      --watch             Build and run the file again whenever it changes, only parsing and checking the statements
+ *                          which need it. With --check-only it is not run, and with --time-stages each rebuild is
+ *                          compared with building the whole file
+ *
+ * Stream Options:
+ *      --stream            Parse, check and run the file one top level statement at a time as it is read, freeing each
+ *                          statement once it has run, so memory does not grow with the length of the file.
+ *                          With --check-only it is not run, and with --time-stages the peak memory is reported.
+ *                          Always interpreted, so --jit is ignored
+ *
+ * REPL Options, only the options for running the program apply to each statement:
+ *      --repl              Read statements from stdin and run each one as soon as it is entered, keeping the
+ *                          globals declared by earlier statements
  */
 int main(int argc, char** argv) {
 
-    //Check argument list size
-    if (argc > 2) {
-        cerr << "Too Many Arguments" << endl;
-        exit(E2BIG);
+    vector<char*> fileNames;
+    bool batch = false;
+    BatchOptions batchOptions;
+    string socketPath;
+    bool repl = false;
+    bool watch = false;
+    bool stream = false;
+    batchOptions.threads = max(1, (int) thread::hardware_concurrency());
+    bool run = false;
+    bool checkOnly = false;
+    bool dumpTokens = false;
+    string xmlFileName;
+    bool timeStages = false;
+    bool statsJSON = false;
+    bool optimise = true;
+    int unrollFactor = DEFAULT_UNROLL_FACTOR;
+    bool emitC = false;
+    string cFileName;
+    bool aot = false;
+    string astFileName;
+    string cacheDirectory;
+    uintmax_t cacheSize = DEFAULT_CACHE_SIZE;
+    int xmlThreads = 1;
+    bool useJIT = false;
+    int jitThreshold = DEFAULT_JIT_THRESHOLD;
+    int osrThreshold = DEFAULT_OSR_THRESHOLD;
+    bool tieringStats = false;
+    bool superinstructions = true;
+    bool countDispatches = false;
+    GovernorLimits limits = GovernorLimits{0, 0, 0, 0};
+    OutputSink& output = OutputSink::standardOutput();
+
+    //Read the argument list
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg == "--run") {
+            run = true;
+        }
+        else if (arg == "--check-only") {
+            checkOnly = true;
+        }
+        else if (arg == "--dump-tokens") {
+            dumpTokens = true;
+        }
+        else if (arg == "--emit-xml") {
+            xmlFileName = DEFAULT_FILENAME;
+        }
+        else if (arg.compare(0, 11, "--emit-xml=") == 0) {
+            xmlFileName = arg.substr(11);
+        }
+        else if (arg == "--time-stages") {
+            timeStages = true;
+        }
+        else if (arg.compare(0, 8, "--stats=") == 0) {
+            if (arg.substr(8) != "json") {
+                cerr << "Statistics format must be json" << endl;
+                exit(EINVAL);
+            }
+            statsJSON = true;
+        }
+        else if (arg == "--no-optimise") {
+            optimise = false;
+        }
+        else if (arg.compare(0, 9, "--unroll=") == 0) {
+            unrollFactor = atoi(arg.c_str() + 9);
+
+            if (unrollFactor < 1) {
+                cerr << "Unroll factor must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg == "--emit-c") {
+            emitC = true;
+        }
+        else if (arg.compare(0, 9, "--emit-c=") == 0) {
+            emitC = true;
+            cFileName = arg.substr(9);
+        }
+        else if (arg.compare(0, 11, "--emit-ast=") == 0) {
+            astFileName = arg.substr(11);
+        }
+        else if (arg.compare(0, 12, "--cache-dir=") == 0) {
+            cacheDirectory = arg.substr(12);
+        }
+        else if (arg.compare(0, 13, "--cache-size=") == 0) {
+            long long megabytes = atoll(arg.c_str() + 13);
+
+            if (megabytes < 1) {
+                cerr << "Cache size must be at least 1 MiB" << endl;
+                exit(EINVAL);
+            }
+            cacheSize = (uintmax_t) megabytes << 20;
+        }
+        else if (arg.compare(0, 14, "--xml-threads=") == 0) {
+            xmlThreads = atoi(arg.c_str() + 14);
+
+            if (xmlThreads < 1) {
+                cerr << "XML threads must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg == "--aot") {
+            aot = true;
+        }
+        else if (arg == "--jit") {
+            useJIT = true;
+        }
+        else if (arg.compare(0, 16, "--jit-threshold=") == 0) {
+            jitThreshold = atoi(arg.c_str() + 16);
+
+            if (jitThreshold < 1) {
+                cerr << "JIT threshold must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg.compare(0, 16, "--osr-threshold=") == 0) {
+            osrThreshold = atoi(arg.c_str() + 16);
+
+            if (osrThreshold < 1) {
+                cerr << "OSR threshold must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg == "--tiering-stats") {
+            useJIT = true;
+            tieringStats = true;
+        }
+        else if (arg == "--no-superinstructions") {
+            superinstructions = false;
+        }
+        else if (arg == "--count-dispatches") {
+            countDispatches = true;
+        }
+        else if (arg.compare(0, 8, "--flush=") == 0) {
+            FlushPolicy policy;
+
+            if (!OutputSink::parsePolicy(arg.substr(8), &policy)) {
+                cerr << "Flush policy must be line, full or never-until-exit" << endl;
+                exit(EINVAL);
+            }
+            output.setPolicy(policy);
+        }
+        else if (arg == "--async-output") {
+            output.setAsync(true);
+        }
+        else if (arg.compare(0, 10, "--max-ops=") == 0) {
+            limits.operations = atoll(arg.c_str() + 10);
+
+            if (limits.operations < 1) {
+                cerr << "Operation limit must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg.compare(0, 11, "--deadline=") == 0) {
+            limits.milliseconds = atoll(arg.c_str() + 11);
+
+            if (limits.milliseconds < 1) {
+                cerr << "Deadline must be at least 1 ms" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg.compare(0, 12, "--max-depth=") == 0) {
+            limits.depth = atoi(arg.c_str() + 12);
+
+            if (limits.depth < 1) {
+                cerr << "Call depth limit must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg.compare(0, 13, "--max-memory=") == 0) {
+            long long megabytes = atoll(arg.c_str() + 13);
+
+            if (megabytes < 1) {
+                cerr << "Memory limit must be at least 1 MiB" << endl;
+                exit(EINVAL);
+            }
+            limits.bytes = megabytes << 20;
+        }
+        else if (arg == "--batch") {
+            batch = true;
+        }
+        else if (arg.compare(0, 16, "--batch-threads=") == 0) {
+            batchOptions.threads = atoi(arg.c_str() + 16);
+
+            if (batchOptions.threads < 1) {
+                cerr << "Batch threads must be at least 1" << endl;
+                exit(EINVAL);
+            }
+        }
+        else if (arg.compare(0, 15, "--batch-output=") == 0) {
+            batchOptions.outputDirectory = arg.substr(15);
+        }
+        else if (arg.compare(0, 8, "--serve=") == 0) {
+            socketPath = arg.substr(8);
+        }
+        else if (arg == "--repl") {
+            repl = true;
+        }
+        else if (arg == "--watch") {
+            watch = true;
+        }
+        else if (arg == "--stream") {
+            stream = true;
+        }
+        else if (arg.compare(0, 2, "--") == 0) {
+            cerr << "Unknown Option " << arg << endl;
+            exit(EINVAL);
+        }
+        else {
+            fileNames.push_back(argv[i]);
+        }
     }
-    else  if (argc < 2) {
+
+    //The JIT's native code does not count its operations, so a limited program is always interpreted
+    if (useJIT && limits.isLimited()) {
+        cerr << "Limits are only enforced by the interpreter, so --jit is ignored" << endl;
+        useJIT = false;
+        tieringStats = false;
+    }
+
+    RunOptions runOptions = RunOptions{optimise, unrollFactor, superinstructions, useJIT, jitThreshold, osrThreshold,
+                                       limits};
+
+    if (!socketPath.empty()) {
+        Server server(socketPath, runOptions);
+        return server.run();
+    }
+
+    if (repl) {
+        Repl session(runOptions);
+        return session.run(cin);
+    }
+
+    if (fileNames.empty()) {
         return 0;
     }
 
+    if (watch) {
+        if (fileNames.size() != 1) {
+            cerr << "Watch expects one file" << endl;
+            exit(EINVAL);
+        }
 
-    //Read the file
-    string program = readFile(argv[1]);
+        Watch watcher(fileNames[0], runOptions, !checkOnly, timeStages);
+        return watcher.run();
+    }
 
+    if (stream) {
+        if (fileNames.size() != 1) {
+            cerr << "Stream expects one file" << endl;
+            exit(EINVAL);
+        }
+        if (useJIT) {
+            cerr << "Streamed scripts are always interpreted, so --jit is ignored" << endl;
+        }
 
-    Parser p = Parser(&program);
-    ASTProgram* node = p.parseProgram();
+        Stream streamed(fileNames[0], runOptions, !checkOnly);
+        int status = streamed.run();
+        if (timeStages) {
+            streamed.printSummary(cerr);
+        }
+        return status;
+    }
 
+    if (batch || fileNames.size() > 1) {
+        batchOptions.run = runOptions;
 
-    auto xml = new XMLVisitor();
-    auto semantic = new SemanticVisitor();
-    auto interpreter = new InterpreterVisitor();
+        return runBatch(fileNames, batch, batchOptions);
+    }
 
+    char* fileName = fileNames[0];
+
+    //Run the program unless only an earlier stage was asked for
+    if (checkOnly) {
+        run = false;
+    }
+    else if (!run) {
+        run = !dumpTokens && astFileName.empty() && !emitC && !aot;
+    }
+
+    //The tokens can be dumped without parsing the program
+    bool parse = run || checkOnly || !xmlFileName.empty() || !astFileName.empty() || emitC || aot;
+
+
+    Statistics statistics;
+    CountVisitor nodes;
+    SemanticVisitor semantic;
+    unique_ptr<JITVisitor> jit(useJIT ? new JITVisitor(jitThreshold, osrThreshold) : nullptr);
+    InterpreterVisitor interpreter(jit.get());
+    int status = 0;
+
+    try {
+        ASTProgram* node = nullptr;
+        bool checked = false;   //True if the program was checked when it was added to the cache
+        auto cache = cacheDirectory.empty() ? nullptr : new CompileCache(cacheDirectory, cacheSize);
+        string program;
+
+        if (BinaryLoader::isBinary(fileName)) {
+            if (dumpTokens) {
+                throw runtime_error("Tokens can only be dumped from TeaLang source.");
+            }
+
+            //Load the program without parsing it, the loader owns the program so is never deleted
+            auto loader = new BinaryLoader(fileName);
+            node = loader->load();
+            statistics.endPhase("load");
+        }
+        else {
+            //Read the file
+            program = readFile(fileName);
+            statistics.endPhase("read");
+
+            if (dumpTokens) {
+                Lexer l(&program);
+                Token t = l.getNextToken();
+                while (t.type != tEND && t.type != tREJECTED) {
+                    string line = t.toString();
+                    output.write(line.data(), line.size());
+                    output.endLine();
+                    t = l.getNextToken();
+                }
+                statistics.setCounter("tokens", l.getTokenCount());
+                statistics.endPhase("tokens");
+            }
+
+            if (parse && cache != nullptr) {
+                node = cache->load(program);
+                checked = (node != nullptr);
+                statistics.endPhase("cache");
+            }
+
+            if (parse && node == nullptr) {
+                Parser p = Parser(&program);
+                if (timeStages || statsJSON) {
+                    p.setStatistics(&statistics);
+                }
+
+                node = p.parseProgram();
+                statistics.setCounter("tokens", p.getTokenCount());
+                statistics.endPhase("parse");
+            }
+        }
 
-    node->accept(xml);
-    node->accept(semantic);
-    node->accept(interpreter);
 
+        if (!xmlFileName.empty()) {
+            XMLVisitor xml(xmlFileName);
+            xml.setThreads(xmlThreads);
+            node->accept(&xml);
+            statistics.endPhase("xml");
+        }
 
+        //Only walk the tree to count its nodes when they are reported, which is left out of the times reported
+        if (statsJSON && node != nullptr) {
+            node->accept(&nodes);
+            statistics.skipPhase();
+        }
 
-//     Lexer
-    /*Lexer l(&program);
-    Token t = l.getNextToken();
-    while (t.type != tEND && t.type != tREJECTED) {
-        cout << t.toString() << endl;
-        t = l.getNextToken();
-    }*/
+        if (parse && !checked) {
+            node->accept(&semantic);
+            statistics.endPhase("semantic");
 
+            if (cache != nullptr && !program.empty()) {
+                cache->store(program, node);
+                statistics.endPhase("cache");
+            }
+        }
 
 
+        //Save the program, which loads faster than parsing it
+        if (!astFileName.empty()) {
+            BinaryVisitor writer;
+            node->accept(&writer);
+            writer.write(astFileName);
+            statistics.endPhase("emit-ast");
+        }
 
-    return 0;
+
+        //Compile the program to C
+        if (emitC || aot) {
+            CVisitor compiler;
+            node->accept(&compiler);
+
+            if (emitC && cFileName.empty()) {
+                //Written through the same buffer as the program's output, so the two stay in order
+                string source = compiler.getSource();
+                output.write(source.data(), source.size());
+            }
+            else if (emitC) {
+                writeFile(cFileName, compiler.getSource());
+            }
+            statistics.endPhase("emit-c");
+
+            if (aot) {
+                status = compileAndRun(compiler.getSource());
+                statistics.endPhase("aot");
+            }
+        }
+
+
+        if (run && !aot) {
+            if (optimise) {
+                OptimiserVisitor optimiser(unrollFactor);
+                node->accept(&optimiser);
+                statistics.endPhase("optimise");
+            }
+
+            unique_ptr<Governor> governor(limits.isLimited() ? new Governor(limits) : nullptr);
+            interpreter.setGovernor(governor.get());
+
+            interpreter.setSuperinstructions(superinstructions);
+            node->accept(&interpreter);
+
+            //Write the output before any statistics
+            output.finish();
+            statistics.endPhase("execute");
+
+            if (tieringStats) {
+                jit->printStatistics(cerr);
+            }
+
+            if (countDispatches) {
+                cerr << "Dispatches: " << interpreter.getDispatches() << endl;
+            }
+        }
+    }
+    catch (runtime_error& e) {
+        //Keep everything printed before the error
+        output.finish();
+        cerr << e.what() << endl;
+        status = 1;
+        statistics.endPhase("error");
+    }
+
+    output.finish();
+
+    if (timeStages) {
+        statistics.printTable(cerr);
+    }
+
+    if (statsJSON) {
+        //The counters are kept by the stages whether or not they are reported, and only read here
+        SymbolTable* tables[] = {semantic.getTable(), interpreter.getTable()};
+        long long pushes = 0;
+        long long lookups = 0;
+        for (SymbolTable* table : tables) {
+            pushes += table->getPushes();
+            lookups += table->getLookups();
+        }
+
+        statistics.setCounter("scopes_pushed", pushes);
+        statistics.setCounter("symbol_lookups", lookups);
+        statistics.setCounter("function_calls", interpreter.getCalls());
+        statistics.setCounter("bytes_printed", output.getBytesWritten());
+        for (int kind = 0; kind < NODE_KINDS; kind++) {
+            statistics.setNodeCount(CountVisitor::kindNames[kind], nodes.getCount(kind));
+        }
+        statistics.printJSON(cerr);
+    }
+
+    return status;
+}
+
+
+/*
+ * Runs many scripts at once, then prints how each of them went to stderr.
+ * If lists is true each file is a list of scripts, otherwise each file is a script.
+ * Returns 0 if every script succeeded.
+ */
+int runBatch(const vector<char*>& fileNames, bool lists, const BatchOptions& options) {
+    vector<string> scripts;
+
+    try {
+        for (char* fileName : fileNames) {
+            if (lists) {
+                vector<string> listed = Batch::readList(fileName);
+                scripts.insert(scripts.end(), listed.begin(), listed.end());
+            }
+            else {
+                scripts.emplace_back(fileName);
+            }
+        }
+
+        Batch b(scripts, options);
+        int status = b.run();
+
+        OutputSink::standardOutput().finish();
+        b.printSummary(cerr);
+        return status;
+    }
+    catch (exception& e) {
+        OutputSink::standardOutput().finish();
+        cerr << e.what() << endl;
+        return 1;
+    }
 }
 
 
@@ -88,3 +627,69 @@ string readFile(char* fileName) {
 
     return program;
 }
+
+
+/*
+ * Write a string to a file, replacing its contents.
+ */
+void writeFile(const string& fileName, const string& contents) {
+
+    ofstream f(fileName);
+
+    //Check if file was opened
+    if (!f.is_open()) {
+        cerr << "File " << fileName << " could not be opened" << endl;
+        exit(EBADF);
+    }
+
+    f << contents;
+    f.close();
+}
+
+
+/*
+ * Builds a C program with the system C compiler (or $CC) and runs it.
+ * Returns the exit status of the program.
+ */
+int compileAndRun(const string& source) {
+
+    //Create a temporary directory for the source and executable
+    const char* tmp = getenv("TMPDIR");
+    string directory = string(tmp != nullptr ? tmp : "/tmp") + "/tealang-XXXXXX";
+
+    if (mkdtemp(&directory[0]) == nullptr) {
+        cerr << "Temporary directory could not be created" << endl;
+        exit(errno);
+    }
+
+    string sourceFile = directory + "/program.c";
+    string executable = directory + "/program";
+    writeFile(sourceFile, source);
+
+
+    //Compile the program, after writing out anything printed so far, as the child writes to the same file
+    const char* cc = getenv("CC");
+    string command = string(cc != nullptr ? cc : "cc") + " -O2 -o '" + executable + "' '" + sourceFile + "'";
+
+    cout.flush();
+    OutputSink::standardOutput().flush();
+    int status = system(command.c_str());
+
+    if (status == 0) {
+        //Run the program
+        cout.flush();
+        OutputSink::standardOutput().flush();
+        status = system(("'" + executable + "'").c_str());
+    }
+    else {
+        cerr << "C compilation failed" << endl;
+    }
+
+
+    //Clean up
+    unlink(executable.c_str());
+    unlink(sourceFile.c_str());
+    rmdir(directory.c_str());
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}